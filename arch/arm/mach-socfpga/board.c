@@ -156,6 +156,14 @@ void board_fit_image_post_process(const void *fit, int node, void **p_image,
 			hang();
 	}
 }
+
+void board_fit_image_load_progress(const void *fit, int node,
+				   const void *image, size_t loaded,
+				   size_t size)
+{
+	if (IS_ENABLED(CONFIG_SOCFPGA_SECURE_VAB_AUTH))
+		socfpga_vab_load_progress(image, loaded, size);
+}
 #endif
 
 #if !IS_ENABLED(CONFIG_SPL_BUILD) && IS_ENABLED(CONFIG_FIT)
@@ -59,5 +59,6 @@ struct fcs_hps_vab_certificate_header {
 					 fcs_sha384[0])
 
 int socfpga_vendor_authentication(void **p_image, size_t *p_size);
+void socfpga_vab_load_progress(const void *image, size_t loaded, size_t size);
 
 #endif /* _SECURE_VAB_H_ */
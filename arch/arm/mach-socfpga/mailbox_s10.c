@@ -32,17 +32,24 @@ DECLARE_GLOBAL_DATA_PTR;
 #define MBOX_WRITE_CMD_BUF(data, cin)	\
 	MBOX_WRITEL(data, MBOX_CMD_BUF + ((cin) * sizeof(u32)))
 
+/*
+ * Most SDM responses arrive well within a millisecond, so poll in small
+ * steps rather than sleeping 1ms between checks. The timeouts stay the same.
+ */
+#define MBOX_POLL_US			10
+#define MBOX_POLL_LOOPS(ms)		((ms) * 1000 / MBOX_POLL_US)
+
 static __always_inline int mbox_polling_resp(u32 rout)
 {
 	u32 rin;
-	unsigned long i = 2000;
+	unsigned long i = MBOX_POLL_LOOPS(2000);
 
 	while (i) {
 		rin = MBOX_READL(MBOX_RIN);
 		if (rout != rin)
 			return 0;
 
-		__socfpga_udelay(1000);
+		__socfpga_udelay(MBOX_POLL_US);
 		i--;
 	}
 
@@ -222,13 +229,13 @@ static __always_inline int mbox_send_cmd_common(u8 id, u32 cmd, u8 is_indirect,
 	}
 
 	while (1) {
-		ret = 1000;
+		ret = MBOX_POLL_LOOPS(1000);
 
 		/* Wait for doorbell from SDM */
 		do {
 			if (MBOX_READL(MBOX_DOORBELL_FROM_SDM))
 				break;
-			__socfpga_udelay(1000);
+			__socfpga_udelay(MBOX_POLL_US);
 		} while (--ret);
 
 		if (!ret)
@@ -253,7 +260,14 @@ static __always_inline int mbox_send_cmd_common(u8 id, u32 cmd, u8 is_indirect,
 		/* read response valid offset */
 		rin = MBOX_READL(MBOX_RIN);
 
-		if (rout != rin) {
+		/*
+		 * One doorbell may cover several responses, so handle all of
+		 * them before waiting for the next doorbell
+		 */
+		while (rout != rin) {
+			bool match;
+			int resp_err;
+
 			/* Response received */
 			resp = MBOX_READ_RESP_BUF(rout);
 			rout++;
@@ -263,40 +277,47 @@ static __always_inline int mbox_send_cmd_common(u8 id, u32 cmd, u8 is_indirect,
 			MBOX_WRITEL(rout, MBOX_ROUT);
 
 			/* check client ID and ID */
-			if ((MBOX_RESP_CLIENT_GET(resp) ==
-			     MBOX_CLIENT_ID_UBOOT) &&
-			    (MBOX_RESP_ID_GET(resp) == id)) {
-				int resp_err = MBOX_RESP_ERR_GET(resp);
-
-				if (resp_buf_len) {
-					buf_len = *resp_buf_len;
-					*resp_buf_len = 0;
-				} else {
-					buf_len = 0;
-				}
+			match = MBOX_RESP_CLIENT_GET(resp) ==
+				MBOX_CLIENT_ID_UBOOT &&
+				MBOX_RESP_ID_GET(resp) == id;
+			resp_err = MBOX_RESP_ERR_GET(resp);
+
+			if (match && resp_buf_len) {
+				buf_len = *resp_buf_len;
+				*resp_buf_len = 0;
+			} else {
+				buf_len = 0;
+			}
 
-				resp_len = MBOX_RESP_LEN_GET(resp);
-				while (resp_len) {
-					ret = mbox_polling_resp(rout);
-					if (ret)
-						return ret;
-					/* we need to process response buffer
-					 * even caller doesn't need it
-					 */
-					resp = MBOX_READ_RESP_BUF(rout);
-					rout++;
-					resp_len--;
-					rout %= MBOX_RESP_BUFFER_SIZE;
-					MBOX_WRITEL(rout, MBOX_ROUT);
-					if (buf_len) {
-						/* copy response to buffer */
-						resp_buf[*resp_buf_len] = resp;
-						(*resp_buf_len)++;
-						buf_len--;
-					}
+			/*
+			 * Consume the data words even if the response is not
+			 * ours, so they are not taken for a response header
+			 */
+			resp_len = MBOX_RESP_LEN_GET(resp);
+			while (resp_len) {
+				ret = mbox_polling_resp(rout);
+				if (ret)
+					return ret;
+				/* we need to process response buffer
+				 * even caller doesn't need it
+				 */
+				resp = MBOX_READ_RESP_BUF(rout);
+				rout++;
+				resp_len--;
+				rout %= MBOX_RESP_BUFFER_SIZE;
+				MBOX_WRITEL(rout, MBOX_ROUT);
+				if (buf_len) {
+					/* copy response to buffer */
+					resp_buf[*resp_buf_len] = resp;
+					(*resp_buf_len)++;
+					buf_len--;
 				}
-				return resp_err;
 			}
+
+			if (match)
+				return resp_err;
+
+			rin = MBOX_READL(MBOX_RIN);
 		}
 	}
 
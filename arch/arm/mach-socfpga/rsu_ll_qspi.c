@@ -122,8 +122,101 @@ static bool cpb_corrupted;
 static bool cpb_fixed;
 static bool spt_corrupted;
 
+/**
+ * struct rsu_table_cache - validated SPT/CPB kept between rsu_init() calls
+ * @valid: true if spt and cpb hold what is in flash
+ * @gen: generation number, incremented each time the cache is dropped
+ * @spt_crc: crc32 of spt when it was cached
+ * @cpb_crc: crc32 of cpb when it was cached
+ * @spt_checksum: whether the SPT checksum was checked when it was cached
+ * @spt0_offset: flash offset of SPT0 reported by firmware
+ * @spt1_offset: flash offset of SPT1 reported by firmware
+ */
+static struct rsu_table_cache {
+	bool valid;
+	u32 gen;
+	u32 spt_crc;
+	u32 cpb_crc;
+	int spt_checksum;
+	u32 spt0_offset;
+	u32 spt1_offset;
+} table_cache;
+
 static int load_cpb(void);
 
+/**
+ * drop_table_cache() - forget the cached SPT and CPB
+ *
+ * Called before anything is written to or erased from flash, so that the
+ * next rsu_init() reads and validates both tables again.
+ */
+static void drop_table_cache(void)
+{
+	if (!table_cache.valid)
+		return;
+
+	table_cache.valid = false;
+	table_cache.gen++;
+	rsu_log(RSU_DEBUG, "SPT/CPB cache dropped, gen %u\n",
+		table_cache.gen);
+}
+
+/**
+ * store_table_cache() - remember the SPT and CPB that were just validated
+ */
+static void store_table_cache(void)
+{
+	if (!IS_ENABLED(CONFIG_SOCFPGA_RSU_CACHE) || spt_corrupted ||
+	    cpb_corrupted)
+		return;
+
+	table_cache.spt_crc = crc32(0, (void *)&spt, sizeof(spt));
+	table_cache.cpb_crc = crc32(0, (void *)&cpb, sizeof(cpb));
+	table_cache.spt_checksum = rsu_misc_spt_checksum_enabled();
+	table_cache.spt0_offset = spt0_offset;
+	table_cache.spt1_offset = spt1_offset;
+	table_cache.valid = true;
+}
+
+/**
+ * use_table_cache() - check whether the cached SPT and CPB can be used
+ *
+ * The tables stay in memory after rsu_exit(). Make sure nothing has changed
+ * them since they were validated, and that the SPT checksum setting, which
+ * affects validation, is the same. Firmware is still asked whether it found
+ * a corrupted CPB, as load_cpb() does, since the cached copy cannot show it.
+ *
+ * Return: true if spt and cpb can be used without reading flash
+ */
+static bool use_table_cache(void)
+{
+	struct rsu_status_info status_info;
+
+	if (!IS_ENABLED(CONFIG_SOCFPGA_RSU_CACHE) || !table_cache.valid)
+		return false;
+
+	if (mbox_rsu_status((u32 *)&status_info,
+			    sizeof(status_info) / 4) ||
+	    (!cpb_fixed && (status_info.state == STATE_CPB0_CORRUPTED ||
+			    status_info.state == STATE_CPB0_CPB1_CORRUPTED))) {
+		drop_table_cache();
+		return false;
+	}
+
+	if (table_cache.spt_checksum != rsu_misc_spt_checksum_enabled() ||
+	    crc32(0, (void *)&spt, sizeof(spt)) != table_cache.spt_crc ||
+	    crc32(0, (void *)&cpb, sizeof(cpb)) != table_cache.cpb_crc) {
+		drop_table_cache();
+		return false;
+	}
+
+	spt0_offset = table_cache.spt0_offset;
+	spt1_offset = table_cache.spt1_offset;
+	cpb_slots = (u64 *)&cpb.data[cpb.header.image_ptr_offset];
+
+	return true;
+}
+
 /**
  * get_part_offset() - get a selected partition offset
  * @part_num: the selected partition number
@@ -174,6 +267,7 @@ static int write_dev(u64 offset, void *buf, int len)
 {
 	int ret;
 
+	drop_table_cache();
 	ret = spi_flash_write(flash, (u32)offset, len, buf);
 	if (ret) {
 		rsu_log(RSU_ERR, "write flash error=%i\n", ret);
@@ -194,6 +288,7 @@ static int erase_dev(u64 offset, int len)
 {
 	int ret;
 
+	drop_table_cache();
 	ret = spi_flash_erase(flash, (u32)offset, len);
 	if (ret) {
 		rsu_log(RSU_ERR, "erase flash error=%i\n", ret);
@@ -575,63 +670,33 @@ static int check_spt(void)
 }
 
 /**
- * check_both_spt() - check if both SPTs are same
+ * load_spt() - retrieve SPT from flash
  *
- * Return: 0 for the identical SPTs, or -ve on error
+ * Return: 0 on success, or -1 for error
  */
-static int check_both_spt(void)
+static int load_spt(void)
 {
-	int ret;
-	char *spt0_data;
+	int spt0_good = 0;
+	int spt1_good = 0;
+	int spt_size = spt1_offset - spt0_offset;
+	bool spt_same = false;
 	char *spt1_data;
+	int ret;
 
-	spt0_data = (char *)malloc(SPT_SIZE);
-	if (!spt0_data) {
-		rsu_log(RSU_ERR, "failed to allocate spt0_data\n");
-		return -ENOMEM;
-	}
-
+	/*
+	 * Keep the raw SPT1 so it can be compared with SPT0 without reading
+	 * both tables from flash a second time
+	 */
 	spt1_data = (char *)malloc(SPT_SIZE);
 	if (!spt1_data) {
 		rsu_log(RSU_ERR, "failed to allocate spt1_data\n");
-		free(spt0_data);
 		return -ENOMEM;
 	}
 
-	ret = read_dev(spt0_offset, spt0_data, SPT_SIZE);
-	if (ret) {
-		rsu_log(RSU_ERR, "failed to read spt0_data\n");
-		goto ops_error;
-	}
-
-	ret = read_dev(spt1_offset, spt1_data, SPT_SIZE);
-	if (ret) {
-		rsu_log(RSU_ERR, "failed to read spt1_data\n");
-		goto ops_error;
-	}
-
-	ret = memcmp(spt0_data, spt1_data, SPT_SIZE);
-
-ops_error:
-	free(spt1_data);
-	free(spt0_data);
-	return ret;
-}
-
-/**
- * load_spt() - retrieve SPT from flash
- *
- * Return: 0 on success, or -1 for error
- */
-static int load_spt(void)
-{
-	int spt0_good = 0;
-	int spt1_good = 0;
-	int spt_size = spt1_offset - spt0_offset;
-
 	rsu_log(RSU_DEBUG, "reading SPT1\n");
-	if (read_dev(spt1_offset, &spt, sizeof(spt)) == 0 &&
-	    spt.magic_number == SPT_MAGIC_NUMBER) {
+	ret = read_dev(spt1_offset, spt1_data, SPT_SIZE);
+	memcpy(&spt, spt1_data, sizeof(spt));
+	if (!ret && spt.magic_number == SPT_MAGIC_NUMBER) {
 		if (check_spt() == 0)
 			spt1_good = 1;
 		else
@@ -644,6 +709,7 @@ static int load_spt(void)
 	rsu_log(RSU_DEBUG, "reading SPT0\n");
 	if (read_dev(spt0_offset, &spt, sizeof(spt)) == 0 &&
 	    spt.magic_number == SPT_MAGIC_NUMBER) {
+		spt_same = !memcmp(&spt, spt1_data, SPT_SIZE);
 		if (check_spt() == 0)
 			spt0_good = 1;
 		else
@@ -652,9 +718,10 @@ static int load_spt(void)
 		rsu_log(RSU_ERR, "Bad SPT0 magic number 0x%08X\n",
 			spt.magic_number);
 	}
+	free(spt1_data);
 
 	if (spt0_good && spt1_good) {
-		if (check_both_spt()) {
+		if (!spt_same) {
 			rsu_log(RSU_ERR, "unmatched SPT0/1 data");
 			spt_corrupted = true;
 			return -EINVAL;
@@ -766,50 +833,6 @@ static int check_cpb(void)
 	return 0;
 }
 
-/**
- * check_both_cpb() - check if both CPBs are same
- *
- * Return: 0 for the identical CPBs, or -ve on error
- */
-static int check_both_cpb(void)
-{
-	int ret;
-	char *cpb0_data;
-	char *cpb1_data;
-
-	cpb0_data = (char *)malloc(CPB_SIZE);
-	if (!cpb0_data) {
-		rsu_log(RSU_ERR, "failed to allocate cpb0_data\n");
-		return -ENOMEM;
-	}
-
-	cpb1_data = (char *)malloc(CPB_SIZE);
-	if (!cpb1_data) {
-		rsu_log(RSU_ERR, "failed to allocate cpb1_data\n");
-		free(cpb0_data);
-		return -ENOMEM;
-	}
-
-	ret = read_part(cpb0_part, 0, cpb0_data, CPB_SIZE);
-	if (ret) {
-		rsu_log(RSU_ERR, "failed to read cpb0_data\n");
-		goto ops_error;
-	}
-
-	ret = read_part(cpb1_part, 0, cpb1_data, CPB_SIZE);
-	if (ret) {
-		rsu_log(RSU_ERR, "failed to read cpb1_data\n");
-		goto ops_error;
-	}
-
-	ret = memcmp(cpb0_data, cpb1_data, CPB_SIZE);
-
-ops_error:
-	free(cpb1_data);
-	free(cpb0_data);
-	return ret;
-}
-
 /**
  * save_cpb_to_address() - save cpb to the address
  * @address: the address which cpb is saved to
@@ -863,6 +886,33 @@ static int corrupted_cpb(void)
 	return cpb_corrupted;
 }
 
+/**
+ * find_cpb_parts() - look up the CPB0 and CPB1 partitions in the SPT
+ *
+ * Return: 0 on success, or -1 if either is missing
+ */
+static int find_cpb_parts(void)
+{
+	int x;
+
+	for (x = 0; x < spt.partitions; x++) {
+		if (strcmp(spt.partition[x].name, "CPB0") == 0)
+			cpb0_part = x;
+		else if (strcmp(spt.partition[x].name, "CPB1") == 0)
+			cpb1_part = x;
+
+		if (cpb0_part >= 0 && cpb1_part >= 0)
+			break;
+	}
+
+	if (cpb0_part < 0 || cpb1_part < 0) {
+		rsu_log(RSU_ERR, "Missing CPB0/1 partition\n");
+		return -1;
+	}
+
+	return 0;
+}
+
 /**
  * load_cpb() - retrieve CPB from flash
  *
@@ -870,11 +920,13 @@ static int corrupted_cpb(void)
  */
 static int load_cpb(void)
 {
-	int x;
 	int cpb0_good = 0;
 	int cpb1_good = 0;
 	struct rsu_status_info status_info;
 	int cpb0_corrupted = 0;
+	bool cpb_same = false;
+	char *cpb1_data;
+	int ret;
 
 	if (mbox_rsu_status((u32 *)&status_info,
 			    sizeof(status_info) / 4)) {
@@ -894,24 +946,20 @@ static int load_cpb(void)
 		cpb0_corrupted = 1;
 	}
 
-	for (x = 0; x < spt.partitions; x++) {
-		if (strcmp(spt.partition[x].name, "CPB0") == 0)
-			cpb0_part = x;
-		else if (strcmp(spt.partition[x].name, "CPB1") == 0)
-			cpb1_part = x;
-
-		if (cpb0_part >= 0 && cpb1_part >= 0)
-			break;
-	}
-
-	if (cpb0_part < 0 || cpb1_part < 0) {
-		rsu_log(RSU_ERR, "Missing CPB0/1 partition\n");
+	if (find_cpb_parts())
 		return -1;
+
+	/* As for the SPT, keep CPB1 to compare it with CPB0 */
+	cpb1_data = (char *)malloc(CPB_SIZE);
+	if (!cpb1_data) {
+		rsu_log(RSU_ERR, "failed to allocate cpb1_data\n");
+		return -ENOMEM;
 	}
 
 	rsu_log(RSU_DEBUG, "Reading CPB1\n");
-	if (read_part(cpb1_part, 0, &cpb, sizeof(cpb)) == 0 &&
-	    cpb.header.magic_number == CPB_MAGIC_NUMBER) {
+	ret = read_part(cpb1_part, 0, cpb1_data, CPB_SIZE);
+	memcpy(&cpb, cpb1_data, sizeof(cpb));
+	if (!ret && cpb.header.magic_number == CPB_MAGIC_NUMBER) {
 		cpb_slots = (u64 *)
 			     &cpb.data[cpb.header.image_ptr_offset];
 		if (check_cpb() == 0)
@@ -924,6 +972,7 @@ static int load_cpb(void)
 		rsu_log(RSU_DEBUG, "Reading CPB0\n");
 		if (read_part(cpb0_part, 0, &cpb, sizeof(cpb)) == 0 &&
 		    cpb.header.magic_number == CPB_MAGIC_NUMBER) {
+			cpb_same = !memcmp(&cpb, cpb1_data, CPB_SIZE);
 			cpb_slots = (u64 *)
 				     &cpb.data[cpb.header.image_ptr_offset];
 			if (check_cpb() == 0)
@@ -932,9 +981,10 @@ static int load_cpb(void)
 			rsu_log(RSU_ERR, "Bad CPB0 is bad\n");
 		}
 	}
+	free(cpb1_data);
 
 	if (cpb0_good && cpb1_good) {
-		if (check_both_cpb()) {
+		if (!cpb_same) {
 			rsu_log(RSU_ERR, "unmatched CPB0/1 data");
 			cpb_corrupted = true;
 			return -EINVAL;
@@ -1851,6 +1901,13 @@ int rsu_ll_qspi_init(struct rsu_ll_intf **intf)
 		return -ENODEV;
 	}
 
+	if (use_table_cache() && !find_cpb_parts()) {
+		rsu_log(RSU_DEBUG, "using cached SPT/CPB, gen %u\n",
+			table_cache.gen);
+		*intf = &qspi_ll_intf;
+		return 0;
+	}
+
 	/* get the offset from firmware */
 	if (mbox_rsu_get_spt_offset(spt_offset, 4)) {
 		rsu_log(RSU_ERR,
@@ -1874,6 +1931,7 @@ int rsu_ll_qspi_init(struct rsu_ll_intf **intf)
 		rsu_log(RSU_ERR, "Bad CPB\n");
 		return -1;
 	}
+	store_table_cache();
 
 	*intf = &qspi_ll_intf;
 
@@ -5,6 +5,7 @@
  */
 
 #include <common.h>
+#include <cyclic.h>
 #include <log.h>
 #include <malloc.h>
 #include <asm/arch/mailbox_s10.h>
@@ -17,6 +18,17 @@
 
 #define CHUNKSZ_PER_WD_RESET		(256 * SZ_1K)
 
+/*
+ * SHA384 of the image currently being loaded, fed by
+ * socfpga_vab_load_progress(). @image is NULL when there is none.
+ */
+static struct {
+	sha512_context ctx;
+	const u8 *image;
+	size_t size;
+	size_t hashed;
+} vab_stream;
+
 /*
  * Read the length of the VAB certificate from the end of image
  * and calculate the actual image size (excluding the VAB certificate).
@@ -37,6 +49,49 @@ static size_t get_img_size(u8 *img_buf, size_t img_buf_sz)
 	return 0;
 }
 
+/* Hash @image up to @end, kicking the watchdog after each slice */
+static void vab_stream_hash(const u8 *image, size_t end)
+{
+	size_t len;
+
+	while (vab_stream.hashed < end) {
+		len = min_t(size_t, end - vab_stream.hashed,
+			    CHUNKSZ_PER_WD_RESET);
+		sha384_update(&vab_stream.ctx, image + vab_stream.hashed, len);
+		vab_stream.hashed += len;
+		schedule();
+	}
+}
+
+/*
+ * Hash image data as it is loaded, while it is still in cache. Everything up
+ * to the largest possible VAB certificate at the end is hashed here, the rest
+ * once socfpga_vendor_authentication() knows where the certificate starts.
+ */
+void socfpga_vab_load_progress(const void *image, size_t loaded, size_t size)
+{
+	size_t end;
+
+	if (!loaded) {
+		sha384_starts(&vab_stream.ctx);
+		vab_stream.image = image;
+		vab_stream.size = size;
+		vab_stream.hashed = 0;
+		return;
+	}
+
+	if (vab_stream.image != image || vab_stream.size != size) {
+		vab_stream.image = NULL;
+		return;
+	}
+
+	if (size < MAX_CERT_SIZE + sizeof(u32))
+		return;
+
+	end = min(loaded, size - MAX_CERT_SIZE - sizeof(u32));
+	vab_stream_hash(image, end);
+}
+
 /*
  * Vendor Authorized Boot (VAB) is a security feature for authenticating
  * the images such as U-Boot, ARM trusted Firmware, Linux kernel,
@@ -62,10 +117,16 @@ int socfpga_vendor_authentication(void **p_image, size_t *p_size)
 	size_t img_sz, mbox_data_sz;
 	u8 *cert_hash_ptr, *mbox_relocate_data_addr;
 	u32 resp = 0, resp_len = 1;
+	bool streamed;
 	int ret;
 
 	img_addr = (uintptr_t)*p_image;
 
+	/* A hash started during loading is only good for one attempt */
+	streamed = vab_stream.image == (u8 *)img_addr &&
+		   vab_stream.size == *p_size;
+	vab_stream.image = NULL;
+
 	debug("Authenticating image at address 0x%016llx (%ld bytes)\n",
 	      img_addr, *p_size);
 
@@ -83,8 +144,17 @@ int socfpga_vendor_authentication(void **p_image, size_t *p_size)
 		return -EBFONT;
 	}
 
-	/* Generate HASH384 from the image */
-	sha384_csum_wd((u8 *)img_addr, img_sz, hash384, CHUNKSZ_PER_WD_RESET);
+	/*
+	 * Generate HASH384 from the image, finishing the hash started while
+	 * the image was loaded if there is one for this image
+	 */
+	if (streamed && vab_stream.hashed <= img_sz) {
+		vab_stream_hash((u8 *)img_addr, img_sz);
+		sha384_finish(&vab_stream.ctx, hash384);
+	} else {
+		sha384_csum_wd((u8 *)img_addr, img_sz, hash384,
+			       CHUNKSZ_PER_WD_RESET);
+	}
 
 	cert_hash_ptr = (u8 *)(img_addr + img_sz + VAB_CERT_MAGIC_OFFSET +
 			       VAB_CERT_FIT_SHA384_OFFSET);
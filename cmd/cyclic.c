@@ -64,6 +64,7 @@ static int do_cyclic_list(struct cmd_tbl *cmdtp, int flag, int argc,
 	struct cyclic_info *cyclic;
 	struct hlist_node *tmp;
 	u64 cnt, freq;
+	int i;
 
 	hlist_for_each_entry_safe(cyclic, tmp, cyclic_get_list(), list) {
 		cnt = cyclic->run_cnt * 1000000ULL * 100ULL;
@@ -71,6 +72,20 @@ static int do_cyclic_list(struct cmd_tbl *cmdtp, int flag, int argc,
 		printf("function: %s, cpu-time: %lld us, frequency: %lld.%02d times/s\n",
 		       cyclic->name, cyclic->cpu_time_us,
 		       lldiv(freq, 100), do_div(freq, 100));
+		printf("  max: %lld us, over %u us: %u, runs <1us",
+		       cyclic->max_cpu_time_us, cyclic->budget_us,
+		       cyclic->over_budget);
+		for (i = 0; i < CYCLIC_HIST_BUCKETS; i++) {
+			if (i == CYCLIC_HIST_BUCKETS - 1)
+				printf(" >=%u: %u", 1 << (2 * (i - 1)),
+				       cyclic->hist[i]);
+			else if (i)
+				printf(" <%u: %u", 1 << (2 * i),
+				       cyclic->hist[i]);
+			else
+				printf(": %u", cyclic->hist[i]);
+		}
+		printf("\n");
 	}
 
 	return 0;
@@ -51,6 +51,7 @@ static struct tag_name {
 
 	/* BLOBLISTT_PROJECT_AREA */
 	{ BLOBLISTT_U_BOOT_SPL_HANDOFF, "SPL hand-off" },
+	{ BLOBLISTT_U_BOOT_MMC_HANDOFF, "MMC hand-off" },
 
 	/* BLOBLISTT_VENDOR_AREA */
 };
@@ -218,6 +218,13 @@ uint32_t bootstage_accum(enum bootstage_id id)
 	return duration;
 }
 
+ulong bootstage_get_time(enum bootstage_id id)
+{
+	struct bootstage_record *rec = find_id(gd->bootstage, id);
+
+	return rec ? rec->time_us : 0;
+}
+
 /**
  * Get a record name as a printable string
  *
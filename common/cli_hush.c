@@ -1538,6 +1538,7 @@ static int run_pipe_real(struct pipe *pi)
 	struct child_prog *child;
 	struct built_in_command *x;
 	char *p;
+	int sp;
 # if __GNUC__
 	/* Avoid longjmp clobbering */
 	(void) &i;
@@ -1550,6 +1551,7 @@ static int run_pipe_real(struct pipe *pi)
 	int flag = do_repeat ? CMD_FLAG_REPEAT : 0;
 	struct child_prog *child;
 	char *p;
+	int sp;
 # if __GNUC__
 	/* Avoid longjmp clobbering */
 	(void) &i;
@@ -1616,6 +1618,8 @@ static int run_pipe_real(struct pipe *pi)
 			}
 			return EXIT_SUCCESS;   /* don't worry about errors in set_local_var() yet */
 		}
+		/* Count locally, the pipe may be run again (see hush_cache) */
+		sp = child->sp;
 		for (i = 0; is_assignment(child->argv[i]); i++) {
 			p = insert_var_value(child->argv[i]);
 #ifndef __U_BOOT__
@@ -1624,11 +1628,11 @@ static int run_pipe_real(struct pipe *pi)
 			set_local_var(p, 0);
 #endif
 			if (p != child->argv[i]) {
-				child->sp--;
+				sp--;
 				free(p);
 			}
 		}
-		if (child->sp) {
+		if (sp) {
 			char * str = NULL;
 
 			str = make_string(child->argv + i,
@@ -1756,11 +1760,28 @@ static int run_pipe_real(struct pipe *pi)
 	return -1;
 }
 
+/*
+ * Put back the variable name of a "for" loop which is left part way through,
+ * so that the parse tree can be run again
+ */
+static void restore_for_list(struct pipe *for_pi, char *save_name,
+			     char **list, char **save_list)
+{
+	if (!list)
+		return;
+	free(for_pi->progs->argv[0]);
+	for_pi->progs->argv[0] = save_name;
+	while (*list)
+		free(*list++);
+	free(save_list);
+}
+
 static int run_list_real(struct pipe *pi)
 {
 	char *save_name = NULL;
 	char **list = NULL;
 	char **save_list = NULL;
+	struct pipe *for_pi = NULL;
 	struct pipe *rpipe;
 	int flag_rep = 0;
 #ifndef __U_BOOT__
@@ -1800,6 +1821,8 @@ static int run_list_real(struct pipe *pi)
 				/* check Ctrl-C */
 				ctrlc();
 				if ((had_ctrlc())) {
+					restore_for_list(for_pi, save_name,
+							 list, save_list);
 					return 1;
 				}
 #endif
@@ -1830,6 +1853,7 @@ static int run_list_real(struct pipe *pi)
 					pi->progs->argv[0]);
 				save_list = list;
 				save_name = pi->progs->argv[0];
+				for_pi = pi;
 				pi->progs->argv[0] = NULL;
 				flag_rep = 1;
 			}
@@ -1899,6 +1923,7 @@ static int run_list_real(struct pipe *pi)
 #else
 		if (rcode < -1) {
 			last_return_code = -rcode - 2;
+			restore_for_list(for_pi, save_name, list, save_list);
 			return -2;	/* exit */
 		}
 		last_return_code = rcode;
@@ -1919,6 +1944,7 @@ static int run_list_real(struct pipe *pi)
 		checkjobs(NULL);
 #endif
 	}
+	restore_for_list(for_pi, save_name, list, save_list);
 	return rcode;
 }
 
@@ -3255,6 +3281,183 @@ static int parse_stream_outer(struct in_str *inp, int flag)
 #endif /* __U_BOOT__ */
 }
 
+#ifdef __U_BOOT__
+/*
+ * Cache of parse trees for command strings run with FLAG_EXIT_FROM_LOOP, such
+ * as bootcmd and environment variables executed with 'run'. Entries are found
+ * by the text itself, so a variable which is changed simply misses. Trees are
+ * kept rather than freed after running; run_list_real() and run_pipe_real()
+ * leave them as they found them.
+ */
+#if CONFIG_IS_ENABLED(HUSH_CACHE)
+/**
+ * struct hush_cache_entry - a command string and its parse tree
+ *
+ * @text: copy of the command string, NULL if the entry is free
+ * @hash: hash of @text
+ * @flag: parser flags @text was parsed with
+ * @list: parse tree
+ * @busy: number of runs of @list in progress
+ * @used: value of hush_cache_clock when last used
+ */
+struct hush_cache_entry {
+	char *text;
+	uint hash;
+	int flag;
+	struct pipe *list;
+	int busy;
+	uint used;
+};
+
+static struct hush_cache_entry hush_cache[CONFIG_HUSH_CACHE_ENTRIES];
+static uint hush_cache_clock;
+static bool hush_cache_off;
+
+static uint hush_cache_hash(const char *s)
+{
+	uint hash = 2166136261U;
+
+	while (*s)
+		hash = (hash ^ (uchar)*s++) * 16777619U;
+
+	return hash;
+}
+
+static void hush_cache_free(struct hush_cache_entry *ent)
+{
+	free_pipe_list(ent->list, 0);
+	free(ent->text);
+	ent->list = NULL;
+	ent->text = NULL;
+}
+
+void hush_cache_enable(bool enable)
+{
+	int i;
+
+	hush_cache_off = !enable;
+	if (enable)
+		return;
+	for (i = 0; i < ARRAY_SIZE(hush_cache); i++) {
+		if (hush_cache[i].text && !hush_cache[i].busy)
+			hush_cache_free(&hush_cache[i]);
+	}
+}
+
+/* Parse @s exactly as one pass of parse_stream_outer() would */
+static struct pipe *hush_cache_parse(const char *s, int flag)
+{
+	struct p_context ctx;
+	o_string temp = NULL_O_STRING;
+	struct in_str input;
+	char *p;
+	int rcode;
+
+	if (!(p = strchr(s, '\n')) || *++p) {
+		p = xmalloc(strlen(s) + 2);
+		strcpy(p, s);
+		strcat(p, "\n");
+		setup_string_in_str(&input, p);
+	} else {
+		p = NULL;
+		setup_string_in_str(&input, s);
+	}
+
+	ctx.type = flag;
+	initialize_context(&ctx);
+	update_ifs_map();
+	if (!(flag & FLAG_PARSE_SEMICOLON))
+		mapset((uchar *)";$&|", 0);
+	input.promptmode = 1;
+	rcode = parse_stream(&temp, &ctx, &input,
+			     flag & FLAG_CONT_ON_NEWLINE ? -1 : '\n');
+	if (rcode == 1 || ctx.old_flag) {
+		if (ctx.old_flag)
+			free(ctx.stack);
+		b_free(&temp);
+		free_pipe_list(ctx.list_head, 0);
+		free(p);
+		return NULL;
+	}
+	done_word(&temp, &ctx);
+	done_pipe(&ctx, PIPE_SEQ);
+	b_free(&temp);
+	free(p);
+
+	return ctx.list_head;
+}
+
+/**
+ * hush_cache_run() - run a command string using the cache
+ *
+ * @s: command string
+ * @flag: parser flags
+ * @rcodep: returns the result, as for parse_string_outer()
+ * Return: 0 if @s was run, -ENOENT if the caller must run it the usual way,
+ *	e.g. because it does not parse
+ */
+static int hush_cache_run(const char *s, int flag, int *rcodep)
+{
+	struct hush_cache_entry *ent = NULL, *victim = NULL;
+	uint hash = hush_cache_hash(s);
+	struct pipe *list;
+	int i, code;
+
+	for (i = 0; i < ARRAY_SIZE(hush_cache); i++) {
+		struct hush_cache_entry *cur = &hush_cache[i];
+
+		if (cur->text && cur->hash == hash && cur->flag == flag &&
+		    !strcmp(cur->text, s)) {
+			ent = cur;
+			break;
+		}
+		if (!cur->busy && (!victim || !cur->text ||
+				   (victim->text && cur->used < victim->used)))
+			victim = cur;
+	}
+
+	/* A script running itself needs a tree of its own */
+	if (ent && ent->busy)
+		return -ENOENT;
+
+	if (!ent) {
+		list = hush_cache_parse(s, flag);
+		if (!list)
+			return -ENOENT;
+		if (victim) {
+			if (victim->text)
+				hush_cache_free(victim);
+			ent = victim;
+			ent->text = xstrdup(s);
+			ent->hash = hash;
+			ent->flag = flag;
+			ent->list = list;
+		}
+	} else {
+		list = ent->list;
+	}
+
+	if (ent) {
+		ent->used = ++hush_cache_clock;
+		ent->busy++;
+		code = run_list_real(list);
+		ent->busy--;
+	} else {
+		code = run_list(list);
+	}
+
+	if (code == -2)
+		*rcodep = last_return_code;
+	else
+		*rcodep = code != 0;
+	if (code == -1)
+		flag_repeat = 0;
+
+	return 0;
+}
+#endif /* HUSH_CACHE */
+#endif /* __U_BOOT__ */
+
 #ifndef __U_BOOT__
 static int parse_string_outer(const char *s, int flag)
 #else
@@ -3269,6 +3472,12 @@ int parse_string_outer(const char *s, int flag)
 		return 1;
 	if (!*s)
 		return 0;
+#if CONFIG_IS_ENABLED(HUSH_CACHE)
+	if (!hush_cache_off && (flag & FLAG_EXIT_FROM_LOOP) &&
+	    !(flag & FLAG_REPARSING) && !env_get("IFS") &&
+	    !hush_cache_run(s, flag, &rcode))
+		return rcode;
+#endif
 	if (!(p = strchr(s, '\n')) || *++p) {
 		p = xmalloc(strlen(s) + 2);
 		strcpy(p, s);
@@ -12,7 +12,9 @@
 #include <log.h>
 #include <malloc.h>
 #include <time.h>
+#include <linux/bitops.h>
 #include <linux/errno.h>
+#include <linux/kernel.h>
 #include <linux/list.h>
 #include <asm/global_data.h>
 
@@ -43,11 +45,26 @@ struct cyclic_info *cyclic_register(cyclic_func_t func, uint64_t delay_us,
 	cyclic->name = strdup(name);
 	cyclic->delay_us = delay_us;
 	cyclic->start_time_us = timer_get_us();
+	cyclic->budget_us = CONFIG_CYCLIC_MAX_CPU_TIME_US;
 	hlist_add_head(&cyclic->list, cyclic_get_list());
 
+	/* The new function is due straight away */
+	gd->cyclic_next_us = 0;
+
 	return cyclic;
 }
 
+void cyclic_set_budget(struct cyclic_info *cyclic, uint budget_us)
+{
+	cyclic->budget_us = budget_us;
+	cyclic->already_warned = false;
+}
+
+int cyclic_hist_bucket(uint64_t cpu_time_us)
+{
+	return min((fls64(cpu_time_us) + 1) / 2, CYCLIC_HIST_BUCKETS - 1);
+}
+
 int cyclic_unregister(struct cyclic_info *cyclic)
 {
 	hlist_del(&cyclic->list);
@@ -66,7 +83,21 @@ void cyclic_run(void)
 	if (gd->flags & GD_FLG_CYCLIC_RUNNING)
 		return;
 
+	/* Nothing is registered, so do not even read the timer */
+	if (hlist_empty(cyclic_get_list()))
+		return;
+
+	/*
+	 * schedule() is called from many tight loops, so only look at the
+	 * list once something is due
+	 */
+	now = timer_get_us();
+	if (now < gd->cyclic_next_us)
+		return;
+
 	gd->flags |= GD_FLG_CYCLIC_RUNNING;
+	/* Functions registered from a callback set this back to 0 */
+	gd->cyclic_next_us = U64_MAX;
 	hlist_for_each_entry_safe(cyclic, tmp, cyclic_get_list(), list) {
 		/*
 		 * Check if this cyclic function needs to get called, e.g.
@@ -80,21 +111,29 @@ void cyclic_run(void)
 			cyclic->run_cnt++;
 			cpu_time = timer_get_us() - now;
 			cyclic->cpu_time_us += cpu_time;
+			cyclic->max_cpu_time_us = max(cyclic->max_cpu_time_us,
+						      cpu_time);
+			cyclic->hist[cyclic_hist_bucket(cpu_time)]++;
 
 			/* Check if cpu-time exceeds max allowed time */
-			if ((cpu_time > CONFIG_CYCLIC_MAX_CPU_TIME_US) &&
-			    (!cyclic->already_warned)) {
-				pr_err("cyclic function %s took too long: %lldus vs %dus max\n",
-				       cyclic->name, cpu_time,
-				       CONFIG_CYCLIC_MAX_CPU_TIME_US);
-
-				/*
-				 * Don't disable this function, just warn once
-				 * about this exceeding CPU time usage
-				 */
-				cyclic->already_warned = true;
+			if (cpu_time > cyclic->budget_us) {
+				cyclic->over_budget++;
+				if (!cyclic->already_warned) {
+					pr_err("cyclic function %s took too long: %lldus vs %uus max\n",
+					       cyclic->name, cpu_time,
+					       cyclic->budget_us);
+
+					/*
+					 * Don't disable this function, just
+					 * warn once about this exceeding CPU
+					 * time usage
+					 */
+					cyclic->already_warned = true;
+				}
 			}
 		}
+		gd->cyclic_next_us = min(gd->cyclic_next_us,
+					 cyclic->next_call);
 	}
 	gd->flags &= ~GD_FLG_CYCLIC_RUNNING;
 }
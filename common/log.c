@@ -206,6 +206,8 @@ static int log_dispatch(struct log_rec *rec, const char *fmt, va_list args)
 {
 	struct log_device *ldev;
 	char buf[CONFIG_SYS_CBSIZE];
+	bool emitted = false, formatted = false;
+	va_list raw;
 
 	/*
 	 * When a log driver writes messages (e.g. via the network stack) this
@@ -217,19 +219,32 @@ static int log_dispatch(struct log_rec *rec, const char *fmt, va_list args)
 
 	/* Emit message */
 	gd->processing_msg = true;
+	va_copy(raw, args);
+	rec->fmt = fmt;
+	rec->args = &raw;
 	list_for_each_entry(ldev, &gd->log_head, sibling_node) {
 		if ((ldev->flags & LOGDF_ENABLE) &&
 		    log_passes_filters(ldev, rec)) {
-			if (!rec->msg) {
+			/* Only format the message for devices which want it */
+			if (!rec->msg && !(ldev->flags & LOGDF_RAW)) {
+				va_list ap;
 				int len;
 
-				len = vsnprintf(buf, sizeof(buf), fmt, args);
+				va_copy(ap, args);
+				len = vsnprintf(buf, sizeof(buf), fmt, ap);
+				va_end(ap);
 				rec->msg = buf;
 				gd->log_cont = len && buf[len - 1] != '\n';
+				formatted = true;
 			}
 			ldev->drv->emit(ldev, rec);
+			emitted = true;
 		}
 	}
+	/* If only raw devices took the record, go by the format string */
+	if (emitted && !formatted && *fmt)
+		gd->log_cont = fmt[strlen(fmt) - 1] != '\n';
+	va_end(raw);
 	gd->processing_msg = false;
 	return 0;
 }
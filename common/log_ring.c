@@ -0,0 +1,723 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Log driver keeping binary records in a RAM ring buffer
+ *
+ * A record holds the format string pointer and the raw arguments rather
+ * than the formatted message, so logging costs little more than copying
+ * the arguments. The text is only produced when the log is read back with
+ * 'log dump', or when it is handed to the OS in the device tree.
+ *
+ * With CONFIG_LOG_RING_ADDR the ring lives at a fixed address and survives
+ * a warm reset, as long as the same U-Boot image runs again: the format
+ * strings it points to must still be where they were.
+ */
+
+#include <common.h>
+#include <event.h>
+#include <fdtdec.h>
+#include <log.h>
+#include <malloc.h>
+#include <mapmem.h>
+#include <time.h>
+#include <version_string.h>
+#include <asm/global_data.h>
+#include <dm/ofnode.h>
+#include <linux/ctype.h>
+#include <linux/sizes.h>
+#include <u-boot/crc.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+#define LOG_RING_MAGIC		0x474f4c52	/* "RLOG" */
+#define LOG_RING_ALIGN		8
+#define LOG_RING_MAX_REC	512
+#define LOG_RING_MAX_NAME	32
+#define LOG_RING_MAX_SPEC	16
+
+/* Record flag: the record holds the message text, not fmt and arguments */
+#define LOG_RING_TEXT		BIT(7)
+
+/**
+ * struct log_ring_rec - Header of a record in the ring
+ *
+ * The header is followed by the file and function names, each
+ * NUL-terminated, and then by either the packed arguments for @fmt or, if
+ * @flags has LOG_RING_TEXT, the NUL-terminated message.
+ *
+ * @len: Length of the record including the header, a multiple of
+ *	LOG_RING_ALIGN; 0 marks the end of the data before wrapping
+ * @level: Log level (enum log_level_t)
+ * @flags: Record flags (enum log_rec_flags) and LOG_RING_TEXT
+ * @cat: Log category (enum log_category_t)
+ * @line: Source line number
+ * @time: Timestamp in microseconds
+ * @fmt: Format string of the message
+ */
+struct log_ring_rec {
+	u16 len;
+	u8 level;
+	u8 flags;
+	u16 cat;
+	u16 line;
+	u64 time;
+	ulong fmt;
+};
+
+/**
+ * struct log_ring - The ring buffer
+ *
+ * @magic: LOG_RING_MAGIC
+ * @size: Size of @data in bytes
+ * @image: Identifies the U-Boot image the format pointers belong to
+ * @boots: Number of times U-Boot has started using this ring
+ * @first: Offset of the oldest record in @data
+ * @next: Offset in @data for the next record
+ * @count: Number of records in the ring
+ * @dropped: Number of records overwritten by newer ones
+ * @data: Records
+ */
+struct log_ring {
+	u32 magic;
+	u32 size;
+	u32 image;
+	u32 boots;
+	u32 first;
+	u32 next;
+	u32 count;
+	u32 dropped;
+	u8 data[];
+};
+
+/* Type of the argument taken by a conversion in a format string */
+enum log_ring_arg {
+	LOG_RING_ARG_NONE,
+	LOG_RING_ARG_INT,
+	LOG_RING_ARG_LONG,
+	LOG_RING_ARG_LLONG,
+	LOG_RING_ARG_SIZE,
+	LOG_RING_ARG_PTRDIFF,
+	LOG_RING_ARG_PTR,
+	LOG_RING_ARG_STR,
+	LOG_RING_ARG_BAD,	/* cannot be stored, format it straight away */
+};
+
+/**
+ * struct log_ring_spec - A conversion in a format string
+ *
+ * @len: Number of characters in the conversion, including the '%'
+ * @type: Type of the argument
+ * @width_arg: Width is taken from an int argument
+ * @prec_arg: Precision is taken from an int argument
+ * @prec: Precision given in the format, -1 if none
+ */
+struct log_ring_spec {
+	int len;
+	enum log_ring_arg type;
+	bool width_arg;
+	bool prec_arg;
+	int prec;
+};
+
+static struct log_ring *ring;
+
+static void log_ring_parse(const char *fmt, struct log_ring_spec *spec)
+{
+	const char *s = fmt + 1;
+	char qual = 0;
+
+	spec->width_arg = false;
+	spec->prec_arg = false;
+	spec->prec = -1;
+
+	while (*s && strchr("-+ #0", *s))
+		s++;
+	if (*s == '*') {
+		spec->width_arg = true;
+		s++;
+	} else {
+		while (isdigit(*s))
+			s++;
+	}
+	if (*s == '.') {
+		s++;
+		if (*s == '*') {
+			spec->prec_arg = true;
+			s++;
+		} else {
+			for (spec->prec = 0; isdigit(*s); s++)
+				spec->prec = spec->prec * 10 + *s - '0';
+		}
+	}
+
+	switch (*s) {
+	case 'h':
+		qual = *s++;
+		if (*s == 'h')
+			s++;
+		break;
+	case 'l':
+		qual = *s++;
+		if (*s == 'l') {
+			qual = 'L';
+			s++;
+		}
+		break;
+	case 'L':
+	case 'q':
+		qual = 'L';
+		s++;
+		break;
+	case 'z':
+	case 'Z':
+		qual = 'z';
+		s++;
+		break;
+	case 't':
+		qual = *s++;
+		break;
+	}
+
+	switch (*s) {
+	case '%':
+		spec->type = LOG_RING_ARG_NONE;
+		break;
+	case 'c':
+	case 'd':
+	case 'i':
+	case 'o':
+	case 'u':
+	case 'x':
+	case 'X':
+		if (qual == 'l')
+			spec->type = LOG_RING_ARG_LONG;
+		else if (qual == 'L')
+			spec->type = LOG_RING_ARG_LLONG;
+		else if (qual == 'z')
+			spec->type = LOG_RING_ARG_SIZE;
+		else if (qual == 't')
+			spec->type = LOG_RING_ARG_PTRDIFF;
+		else
+			spec->type = LOG_RING_ARG_INT;
+		break;
+	case 's':
+		spec->type = qual ? LOG_RING_ARG_BAD : LOG_RING_ARG_STR;
+		break;
+	case 'p':
+		/* %p extensions look at the data, which may be gone later */
+		spec->type = isalnum(s[1]) ? LOG_RING_ARG_BAD : LOG_RING_ARG_PTR;
+		break;
+	default:
+		spec->type = LOG_RING_ARG_BAD;
+		break;
+	}
+	spec->len = s - fmt + (*s ? 1 : 0);
+	if (spec->len > LOG_RING_MAX_SPEC)
+		spec->type = LOG_RING_ARG_BAD;
+}
+
+#define LOG_RING_PUT(_p, _end, _val) ({				\
+	typeof(_val) __val = (_val);					\
+									\
+	if ((_p) + sizeof(__val) > (_end))				\
+		return -ENOSPC;						\
+	memcpy(_p, &__val, sizeof(__val));				\
+	(_p) += sizeof(__val);						\
+})
+
+/* Store the arguments for @fmt, returning their size */
+static int log_ring_pack(u8 *buf, int size, const char *fmt, va_list args)
+{
+	struct log_ring_spec spec;
+	u8 *p = buf, *end = buf + size;
+
+	for (; *fmt; fmt++) {
+		const char *str;
+		int prec, len;
+
+		if (*fmt != '%')
+			continue;
+		log_ring_parse(fmt, &spec);
+		if (spec.type == LOG_RING_ARG_BAD)
+			return -EINVAL;
+		fmt += spec.len - 1;
+
+		if (spec.width_arg)
+			LOG_RING_PUT(p, end, va_arg(args, int));
+		prec = spec.prec;
+		if (spec.prec_arg) {
+			prec = va_arg(args, int);
+			LOG_RING_PUT(p, end, prec);
+		}
+
+		switch (spec.type) {
+		case LOG_RING_ARG_INT:
+			LOG_RING_PUT(p, end, va_arg(args, int));
+			break;
+		case LOG_RING_ARG_LONG:
+			LOG_RING_PUT(p, end, va_arg(args, long));
+			break;
+		case LOG_RING_ARG_LLONG:
+			LOG_RING_PUT(p, end, va_arg(args, long long));
+			break;
+		case LOG_RING_ARG_SIZE:
+			LOG_RING_PUT(p, end, va_arg(args, size_t));
+			break;
+		case LOG_RING_ARG_PTRDIFF:
+			LOG_RING_PUT(p, end, va_arg(args, ptrdiff_t));
+			break;
+		case LOG_RING_ARG_PTR:
+			LOG_RING_PUT(p, end, va_arg(args, void *));
+			break;
+		case LOG_RING_ARG_STR:
+			/* The string may not outlive the call, so copy it */
+			str = va_arg(args, const char *);
+			LOG_RING_PUT(p, end, (u8)!!str);
+			if (!str)
+				break;
+			len = prec >= 0 ? strnlen(str, prec) : strlen(str);
+			if (p + len + 1 > end)
+				return -ENOSPC;
+			memcpy(p, str, len);
+			p[len] = '\0';
+			p += len + 1;
+			break;
+		default:
+			break;
+		}
+	}
+
+	return p - buf;
+}
+
+#define LOG_RING_GET(_p, _end, _type) ({				\
+	_type __val = 0;						\
+									\
+	if ((_p) + sizeof(__val) <= (_end))				\
+		memcpy(&__val, _p, sizeof(__val));			\
+	(_p) += sizeof(__val);						\
+	__val;								\
+})
+
+/* Copy a conversion, replacing each '*' with its argument */
+static void log_ring_spec_str(char *out, int size, const char *fmt, int len,
+			      const u8 **pp, const u8 *end)
+{
+	char *o = out;
+	int i;
+
+	for (i = 0; i < len && o < out + size - 12; i++) {
+		if (fmt[i] == '*')
+			o += sprintf(o, "%d", LOG_RING_GET(*pp, end, int));
+		else
+			*o++ = fmt[i];
+	}
+	*o = '\0';
+}
+
+/* Format a message from @fmt and the arguments stored by log_ring_pack() */
+static int log_ring_format(char *out, int size, const char *fmt,
+			   const u8 *args, const u8 *end)
+{
+	struct log_ring_spec spec;
+	char conv[LOG_RING_MAX_SPEC + 2 * 12];
+	const u8 *p = args;
+	int pos = 0;
+
+	for (; *fmt && pos < size - 1; fmt++) {
+		const char *str;
+		int n;
+
+		if (*fmt != '%') {
+			out[pos++] = *fmt;
+			continue;
+		}
+		log_ring_parse(fmt, &spec);
+		log_ring_spec_str(conv, sizeof(conv), fmt, spec.len, &p, end);
+		fmt += spec.len - 1;
+
+		switch (spec.type) {
+		case LOG_RING_ARG_NONE:
+			n = snprintf(out + pos, size - pos, "%%");
+			break;
+		case LOG_RING_ARG_INT:
+			n = snprintf(out + pos, size - pos, conv,
+				     LOG_RING_GET(p, end, int));
+			break;
+		case LOG_RING_ARG_LONG:
+			n = snprintf(out + pos, size - pos, conv,
+				     LOG_RING_GET(p, end, long));
+			break;
+		case LOG_RING_ARG_LLONG:
+			n = snprintf(out + pos, size - pos, conv,
+				     LOG_RING_GET(p, end, long long));
+			break;
+		case LOG_RING_ARG_SIZE:
+			n = snprintf(out + pos, size - pos, conv,
+				     LOG_RING_GET(p, end, size_t));
+			break;
+		case LOG_RING_ARG_PTRDIFF:
+			n = snprintf(out + pos, size - pos, conv,
+				     LOG_RING_GET(p, end, ptrdiff_t));
+			break;
+		case LOG_RING_ARG_PTR:
+			n = snprintf(out + pos, size - pos, conv,
+				     LOG_RING_GET(p, end, void *));
+			break;
+		case LOG_RING_ARG_STR:
+			str = NULL;
+			if (LOG_RING_GET(p, end, u8) && p < end) {
+				str = (const char *)p;
+				p += strnlen(str, end - p) + 1;
+			}
+			n = snprintf(out + pos, size - pos, conv, str);
+			break;
+		default:
+			n = 0;
+			break;
+		}
+		pos += min(n, size - 1 - pos);
+	}
+	out[pos] = '\0';
+
+	return pos;
+}
+
+static u32 log_ring_image(void)
+{
+	ulong anchor = (ulong)log_ring_image;
+
+	return crc32(crc32(0, (const u8 *)version_string,
+			   strlen(version_string)),
+		     (const u8 *)&anchor, sizeof(anchor));
+}
+
+static struct log_ring_rec *log_ring_rec(struct log_ring *lr, u32 off)
+{
+	return (struct log_ring_rec *)(lr->data + off);
+}
+
+/* Get the offset of the record after the one at @off */
+static u32 log_ring_next(struct log_ring *lr, u32 off)
+{
+	off += log_ring_rec(lr, off)->len;
+	if (off >= lr->size || !log_ring_rec(lr, off)->len)
+		off = 0;
+
+	return off;
+}
+
+/* Drop the oldest records while they start between @start and @end */
+static void log_ring_evict(u32 start, u32 end)
+{
+	while (ring->count && ring->first >= start && ring->first < end) {
+		ring->first = log_ring_next(ring, ring->first);
+		ring->count--;
+		ring->dropped++;
+	}
+}
+
+static void log_ring_put(const struct log_ring_rec *rec)
+{
+	if (ring->next + rec->len > ring->size) {
+		log_ring_evict(ring->next, ring->size);
+		if (ring->next < ring->size)
+			log_ring_rec(ring, ring->next)->len = 0;
+		ring->next = 0;
+	}
+	log_ring_evict(ring->next, ring->next + rec->len);
+	if (!ring->count)
+		ring->first = ring->next;
+
+	memcpy(ring->data + ring->next, rec, rec->len);
+	ring->next += rec->len;
+	ring->count++;
+}
+
+/* Check that @lr holds records from this image which can be walked */
+static bool log_ring_valid(struct log_ring *lr, u32 size)
+{
+	u32 off, i;
+
+	if (lr->magic != LOG_RING_MAGIC || lr->size != size ||
+	    lr->image != log_ring_image() || lr->count > size ||
+	    lr->first >= size || lr->next > size ||
+	    lr->first % LOG_RING_ALIGN || lr->next % LOG_RING_ALIGN)
+		return false;
+
+	for (i = 0, off = lr->first; i < lr->count; i++) {
+		struct log_ring_rec *rec = log_ring_rec(lr, off);
+
+		if (rec->len < sizeof(*rec) || rec->len > LOG_RING_MAX_REC ||
+		    rec->len % LOG_RING_ALIGN || off + rec->len > size)
+			return false;
+		off = log_ring_next(lr, off);
+	}
+
+	return true;
+}
+
+/* Store a NUL-terminated string, returning the position after it */
+static char *log_ring_put_str(char *p, const char *str, int size)
+{
+	strlcpy(p, str, size);
+
+	return p + strlen(p) + 1;
+}
+
+static void log_ring_add_text(const char *file, const char *func,
+			      const char *msg)
+{
+	u8 buf[LOG_RING_MAX_REC] __aligned(LOG_RING_ALIGN);
+	struct log_ring_rec *rec = (struct log_ring_rec *)buf;
+	char *p = (char *)(rec + 1);
+	char *end = (char *)buf + sizeof(buf);
+
+	p = log_ring_put_str(p, file, LOG_RING_MAX_NAME);
+	p = log_ring_put_str(p, func, LOG_RING_MAX_NAME);
+	p = log_ring_put_str(p, msg, end - p);
+
+	rec->len = ALIGN(p - (char *)buf, LOG_RING_ALIGN);
+	rec->level = LOGL_INFO;
+	rec->flags = LOG_RING_TEXT;
+	rec->cat = LOGC_NONE;
+	rec->line = 0;
+	rec->time = timer_get_us();
+	rec->fmt = 0;
+	log_ring_put(rec);
+}
+
+int log_ring_setup(void *buf, ulong size)
+{
+	static struct log_ring *def_ring;
+	struct log_ring *lr;
+	char msg[32];
+	u32 data_size;
+
+	if (!buf) {
+		/* Going back to the default ring must not count as a boot */
+		if (def_ring) {
+			ring = def_ring;
+			return 0;
+		}
+		if (CONFIG_LOG_RING_ADDR)
+			buf = map_sysmem(CONFIG_LOG_RING_ADDR,
+					 CONFIG_LOG_RING_SIZE);
+		else
+			buf = memalign(LOG_RING_ALIGN, CONFIG_LOG_RING_SIZE);
+		if (!buf)
+			return -ENOMEM;
+		size = CONFIG_LOG_RING_SIZE;
+		def_ring = buf;
+	}
+	if (size < sizeof(*lr) + LOG_RING_MAX_REC)
+		return -EINVAL;
+
+	lr = buf;
+	data_size = ALIGN_DOWN(size - sizeof(*lr), LOG_RING_ALIGN);
+	if (!log_ring_valid(lr, data_size)) {
+		memset(lr, '\0', sizeof(*lr));
+		lr->magic = LOG_RING_MAGIC;
+		lr->size = data_size;
+		lr->image = log_ring_image();
+	}
+	ring = lr;
+
+	if (ring->boots++) {
+		snprintf(msg, sizeof(msg), "--- boot %u ---\n", ring->boots);
+		log_ring_add_text("", "", msg);
+	}
+
+	return 0;
+}
+
+void log_ring_clear(void)
+{
+	if (!ring)
+		return;
+	ring->first = 0;
+	ring->next = 0;
+	ring->count = 0;
+	ring->dropped = 0;
+}
+
+static int log_ring_emit(struct log_device *ldev, struct log_rec *rec)
+{
+	u8 buf[LOG_RING_MAX_REC] __aligned(LOG_RING_ALIGN);
+	struct log_ring_rec *lrec = (struct log_ring_rec *)buf;
+	char *p = (char *)(lrec + 1);
+	char *end = (char *)buf + sizeof(buf);
+	va_list args;
+	int len = -EINVAL;
+
+	/* Before relocation the format strings are not where they end up */
+	if (!(gd->flags & GD_FLG_RELOC))
+		return 0;
+	if (!ring && log_ring_setup(NULL, 0))
+		return -ENOMEM;
+
+	lrec->level = rec->level;
+	lrec->flags = rec->flags;
+	lrec->cat = rec->cat;
+	lrec->line = rec->line;
+	lrec->time = timer_get_us();
+	p = log_ring_put_str(p, rec->file ? rec->file : "", LOG_RING_MAX_NAME);
+	p = log_ring_put_str(p, rec->func ? rec->func : "", LOG_RING_MAX_NAME);
+
+	if (rec->fmt && rec->args) {
+		va_copy(args, *rec->args);
+		len = log_ring_pack((u8 *)p, end - p, rec->fmt, args);
+		va_end(args);
+		lrec->fmt = (ulong)rec->fmt;
+	}
+	if (len < 0) {
+		/* Keep the text of messages which cannot be deferred */
+		lrec->flags |= LOG_RING_TEXT;
+		lrec->fmt = 0;
+		if (rec->msg) {
+			strlcpy(p, rec->msg, end - p);
+		} else {
+			va_copy(args, *rec->args);
+			vsnprintf(p, end - p, rec->fmt, args);
+			va_end(args);
+		}
+		len = strlen(p) + 1;
+	}
+	lrec->len = ALIGN(p + len - (char *)buf, LOG_RING_ALIGN);
+	log_ring_put(lrec);
+
+	return 0;
+}
+
+/* Format a record the way the console driver shows it */
+static void log_ring_line(const struct log_ring_rec *rec, char *out, int size)
+{
+	const char *file = (const char *)(rec + 1);
+	const char *func = file + strlen(file) + 1;
+	const char *args = func + strlen(func) + 1;
+	const u8 *end = (const u8 *)rec + rec->len;
+	int fmt = gd->log_fmt;
+	int pos = 0;
+
+	if (!(rec->flags & LOGRECF_CONT)) {
+		pos += snprintf(out + pos, size - pos, "[%5llu.%06llu] ",
+				rec->time / 1000000, rec->time % 1000000);
+		if (fmt != BIT(LOGF_MSG)) {
+			if (fmt & BIT(LOGF_LEVEL))
+				pos += snprintf(out + pos, size - pos, "%s.",
+						log_get_level_name(rec->level));
+			if (fmt & BIT(LOGF_CAT))
+				pos += snprintf(out + pos, size - pos, "%s,",
+						log_get_cat_name(rec->cat));
+			if (fmt & BIT(LOGF_FILE))
+				pos += snprintf(out + pos, size - pos, "%s:",
+						file);
+			if (fmt & BIT(LOGF_LINE))
+				pos += snprintf(out + pos, size - pos, "%d-",
+						rec->line);
+			if (fmt & BIT(LOGF_FUNC))
+				pos += snprintf(out + pos, size - pos, "%*s()",
+						CONFIG_LOGF_FUNC_PAD, func);
+			pos += snprintf(out + pos, size - pos, " ");
+		}
+	}
+	pos = min(pos, size - 1);
+	if (!(fmt & BIT(LOGF_MSG)))
+		snprintf(out + pos, size - pos, "\n");
+	else if (rec->flags & LOG_RING_TEXT)
+		strlcpy(out + pos, args, size - pos);
+	else
+		log_ring_format(out + pos, size - pos,
+				(const char *)rec->fmt, (const u8 *)args, end);
+}
+
+static int log_ring_walk(int (*func)(void *ctx, const char *line), void *ctx)
+{
+	char line[CONFIG_SYS_CBSIZE];
+	u32 off, i;
+	int ret;
+
+	if (!ring)
+		return 0;
+
+	for (i = 0, off = ring->first; i < ring->count; i++) {
+		log_ring_line(log_ring_rec(ring, off), line, sizeof(line));
+		ret = func(ctx, line);
+		if (ret)
+			return ret;
+		off = log_ring_next(ring, off);
+	}
+
+	return 0;
+}
+
+static int log_ring_puts(void *ctx, const char *line)
+{
+	puts(line);
+
+	return 0;
+}
+
+void log_ring_dump(void)
+{
+	if (ring && ring->dropped)
+		printf("(%u older records dropped)\n", ring->dropped);
+	log_ring_walk(log_ring_puts, NULL);
+}
+
+#if CONFIG_IS_ENABLED(LOG_RING_FDT)
+static int log_ring_measure(void *ctx, const char *line)
+{
+	*(ulong *)ctx += strlen(line);
+
+	return 0;
+}
+
+static int log_ring_copy(void *ctx, const char *line)
+{
+	char **pp = ctx;
+
+	strcpy(*pp, line);
+	*pp += strlen(line);
+
+	return 0;
+}
+
+/* Hand a text copy of the log to the OS in a reserved-memory node */
+static int log_ring_ft_fixup(void *ctx, struct event *event)
+{
+	void *blob = oftree_lookup_fdt(event->data.ft_fixup.tree);
+	const char *compat = "u-boot,log";
+	struct fdt_memory mem;
+	ulong size = 1;
+	char *text, *p;
+	int ret;
+
+	if (!ring || !ring->count || !blob)
+		return 0;
+
+	log_ring_walk(log_ring_measure, &size);
+	size = ALIGN(size, SZ_4K);
+	text = memalign(SZ_4K, size);
+	if (!text)
+		return log_msg_ret("log", -ENOMEM);
+	p = text;
+	log_ring_walk(log_ring_copy, &p);
+	memset(p, '\0', text + size - p);
+
+	mem.start = map_to_sysmem(text);
+	mem.end = mem.start + size - 1;
+	ret = fdtdec_add_reserved_memory(blob, "u-boot-log", &mem, &compat, 1,
+					 NULL, FDTDEC_RESERVED_MEMORY_NO_MAP);
+	if (ret)
+		return log_msg_ret("res", ret);
+
+	return 0;
+}
+EVENT_SPY(EVT_FT_FIXUP, log_ring_ft_fixup);
+#endif
+
+LOG_DRIVER(ring) = {
+	.name	= "ring",
+	.emit	= log_ring_emit,
+	.flags	= LOGDF_ENABLE | LOGDF_RAW,
+};
@@ -885,7 +885,8 @@ void board_init_r(gd_t *dummy1, ulong dummy2)
 #endif
 	bootstage_mark_name(get_bootstage_id(false), "end phase");
 #ifdef CONFIG_BOOTSTAGE_STASH
-	ret = bootstage_stash((void *)CONFIG_BOOTSTAGE_STASH_ADDR,
+	ret = bootstage_stash(map_sysmem(CONFIG_BOOTSTAGE_STASH_ADDR,
+					 CONFIG_BOOTSTAGE_STASH_SIZE),
 			      CONFIG_BOOTSTAGE_STASH_SIZE);
 	if (ret)
 		debug("Failed to stash bootstage: err=%d\n", ret);
@@ -5,6 +5,7 @@
  */
 
 #include <common.h>
+#include <bootstage.h>
 #include <errno.h>
 #include <fpga.h>
 #include <gzip.h>
@@ -17,6 +18,7 @@
 #include <asm/cache.h>
 #include <asm/global_data.h>
 #include <linux/libfdt.h>
+#include <linux/sizes.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
@@ -27,11 +29,20 @@ struct spl_fit_info {
 	int conf_node;		/* FDT offset to selected configuration node */
 };
 
+/* Amount of image data read between calls to board_fit_image_load_progress() */
+#define SPL_FIT_READ_CHUNK	SZ_256K
+
 __weak ulong board_spl_fit_size_align(ulong size)
 {
 	return size;
 }
 
+__weak void board_fit_image_load_progress(const void *fit, int node,
+					  const void *image, size_t loaded,
+					  size_t size)
+{
+}
+
 static int find_node_from_desc(const void *fit, int node, const char *str)
 {
 	int child;
@@ -206,6 +217,87 @@ static int get_aligned_image_size(struct spl_load_info *info, int data_size,
 	return (data_size + info->bl_len - 1) / info->bl_len;
 }
 
+/**
+ * spl_fit_read_direct() - read external image data straight to its load address
+ * @info:	points to information about the device to load data from
+ * @sector:	the start sector of the FIT image on the device
+ * @fit:	points to the FIT
+ * @node:	offset of the DT node describing the image
+ * @offset:	byte offset of the image data from the start of the FIT
+ * @length:	number of bytes of image data
+ * @dst:	final location of the image data
+ *
+ * Whole blocks are read into @dst itself, so the image is not staged and then
+ * copied into place. The partial blocks at the start and end of the data, if
+ * any, go through a block-sized bounce buffer so that nothing outside
+ * @dst..@dst + @length is written. The bounce buffer is kept for later images
+ * since SPL's simple malloc() cannot free it.
+ *
+ * With CONFIG_SPL_FIT_READ_CHUNKED, whole blocks are read in chunks of
+ * SPL_FIT_READ_CHUNK bytes and board_fit_image_load_progress() is told about
+ * each one as it arrives.
+ *
+ * Return:	0 on success, -EINVAL if the whole blocks would not land on a
+ *		DMA-aligned address, -ENOMEM if there is no room for the bounce
+ *		buffer, or -EIO on a read error. For -EINVAL and -ENOMEM nothing
+ *		has been read and the caller may fall back to a staging buffer.
+ */
+static int spl_fit_read_direct(struct spl_load_info *info, ulong sector,
+			       const void *fit, int node, int offset,
+			       size_t length, void *dst)
+{
+	static void *buf;
+	static ulong buf_len;
+	ulong bl_len = info->filename ? 1 : info->bl_len;
+	ulong head = offset % bl_len;
+	ulong blk = sector + offset / bl_len;
+	size_t done = 0, nr_blocks, chunk, count;
+
+	if (head)
+		done = min_t(size_t, length, bl_len - head);
+	nr_blocks = (length - done) / bl_len;
+	if (nr_blocks && !IS_ALIGNED((ulong)dst + done, ARCH_DMA_MINALIGN))
+		return -EINVAL;
+
+	if ((head || (length - done) % bl_len) && buf_len < bl_len) {
+		buf = malloc_cache_aligned(bl_len);
+		if (!buf)
+			return -ENOMEM;
+		buf_len = bl_len;
+	}
+
+	board_fit_image_load_progress(fit, node, dst, 0, length);
+	if (head) {
+		if (info->read(info, blk, 1, buf) != 1)
+			return -EIO;
+		memcpy(dst, buf + head, done);
+		blk++;
+		board_fit_image_load_progress(fit, node, dst, done, length);
+	}
+
+	chunk = nr_blocks;
+	if (CONFIG_IS_ENABLED(FIT_READ_CHUNKED))
+		chunk = max_t(size_t, SPL_FIT_READ_CHUNK / bl_len, 1);
+	while (nr_blocks) {
+		count = min(nr_blocks, chunk);
+		if (info->read(info, blk, count, dst + done) != count)
+			return -EIO;
+		done += count * bl_len;
+		blk += count;
+		nr_blocks -= count;
+		board_fit_image_load_progress(fit, node, dst, done, length);
+	}
+
+	if (done < length) {
+		if (info->read(info, blk, 1, buf) != 1)
+			return -EIO;
+		memcpy(dst + done, buf, length - done);
+		board_fit_image_load_progress(fit, node, dst, length, length);
+	}
+
+	return 0;
+}
+
 /**
  * spl_load_fit_image(): load the image described in a certain FIT node
  * @info:	points to information about the device to load data from
@@ -237,6 +329,10 @@ static int spl_load_fit_image(struct spl_load_info *info, ulong sector,
 	const void *data;
 	const void *fit = ctx->fit;
 	bool external_data = false;
+	bool decomp;
+	ulong count;
+	bool ok;
+	int ret;
 
 	if (IS_ENABLED(CONFIG_SPL_FPGA) ||
 	    (IS_ENABLED(CONFIG_SPL_OS_BOOT) && IS_ENABLED(CONFIG_SPL_GZIP))) {
@@ -250,6 +346,7 @@ static int spl_load_fit_image(struct spl_load_info *info, ulong sector,
 		fit_image_get_comp(fit, node, &image_comp);
 		debug("%s ", genimg_get_comp_name(image_comp));
 	}
+	decomp = IS_ENABLED(CONFIG_SPL_GZIP) && image_comp == IH_COMP_GZIP;
 
 	if (fit_image_get_load(fit, node, &load_addr)) {
 		if (!image_info->load_addr) {
@@ -281,19 +378,46 @@ static int spl_load_fit_image(struct spl_load_info *info, ulong sector,
 			return 0;
 		}
 
-		src_ptr = map_sysmem(ALIGN(load_addr, ARCH_DMA_MINALIGN), len);
 		length = len;
+		bootstage_start(BOOTSTAGE_ID_ACCUM_SPL_FIT_READ, "spl_fit_read");
 
-		overhead = get_aligned_image_overhead(info, offset);
-		nr_sectors = get_aligned_image_size(info, length, offset);
-
-		if (info->read(info,
-			       sector + get_aligned_image_offset(info, offset),
-			       nr_sectors, src_ptr) != nr_sectors)
-			return -EIO;
+		/*
+		 * Uncompressed data can usually be read in place, avoiding a
+		 * staging copy of the whole image
+		 */
+		ret = -EINVAL;
+		if (!decomp) {
+			src_ptr = map_sysmem(load_addr, length);
+			ret = spl_fit_read_direct(info, sector, fit, node,
+						  offset, length, src_ptr);
+			if (ret == -EIO)
+				return ret;
+			overhead = 0;
+		}
+		if (ret) {
+			src_ptr = map_sysmem(ALIGN(load_addr, ARCH_DMA_MINALIGN),
+					     len);
+			overhead = get_aligned_image_overhead(info, offset);
+			nr_sectors = get_aligned_image_size(info, length,
+							    offset);
+
+			board_fit_image_load_progress(fit, node,
+						      src_ptr + overhead,
+						      0, length);
+			count = info->read(info, sector +
+					   get_aligned_image_offset(info, offset),
+					   nr_sectors, src_ptr);
+			if (count != nr_sectors)
+				return -EIO;
+			board_fit_image_load_progress(fit, node,
+						      src_ptr + overhead,
+						      length, length);
+		}
+		bootstage_accum(BOOTSTAGE_ID_ACCUM_SPL_FIT_READ);
 
-		debug("External data: dst=%p, offset=%x, size=%lx\n",
-		      src_ptr, offset, (unsigned long)length);
+		debug("External data: dst=%p, offset=%x, size=%lx%s\n",
+		      src_ptr, offset, (unsigned long)length,
+		      ret ? "" : " (direct)");
 		src = src_ptr + overhead;
 	} else {
 		/* Embedded data */
@@ -309,8 +433,12 @@ static int spl_load_fit_image(struct spl_load_info *info, ulong sector,
 	if (CONFIG_IS_ENABLED(FIT_SIGNATURE)) {
 		printf("## Checking hash(es) for Image %s ... ",
 		       fit_get_name(fit, node, NULL));
-		if (!fit_image_verify_with_data(fit, node, gd_fdt_blob(), src,
-						length))
+		bootstage_start(BOOTSTAGE_ID_ACCUM_SPL_FIT_VERIFY,
+				"spl_fit_verify");
+		ok = fit_image_verify_with_data(fit, node, gd_fdt_blob(), src,
+						length);
+		bootstage_accum(BOOTSTAGE_ID_ACCUM_SPL_FIT_VERIFY);
+		if (!ok)
 			return -EPERM;
 		puts("OK\n");
 	}
@@ -319,14 +447,17 @@ static int spl_load_fit_image(struct spl_load_info *info, ulong sector,
 		board_fit_image_post_process(fit, node, &src, &length);
 
 	load_ptr = map_sysmem(load_addr, length);
-	if (IS_ENABLED(CONFIG_SPL_GZIP) && image_comp == IH_COMP_GZIP) {
+	if (decomp) {
 		size = length;
-		if (gunzip(load_ptr, CONFIG_SYS_BOOTM_LEN, src, &size)) {
+		bootstage_start(BOOTSTAGE_ID_ACCUM_DECOMP, "decompress");
+		ret = gunzip(load_ptr, CONFIG_SYS_BOOTM_LEN, src, &size);
+		bootstage_accum(BOOTSTAGE_ID_ACCUM_DECOMP);
+		if (ret) {
 			puts("Uncompressing error\n");
 			return -EIO;
 		}
 		length = size;
-	} else {
+	} else if (src != load_ptr) {
 		memcpy(load_ptr, src, length);
 	}
 
@@ -66,6 +66,11 @@ static const unsigned char us_direction[256/8] = {
 };
 #define US_DIRECTION(x) ((us_direction[x>>3] >> (x & 7)) & 1)
 
+/* Transfer limit known to work with all devices */
+#define USB_MAX_XFER_BLK	240
+/* Larger limit tried first on SuperSpeed devices */
+#define USB_MAX_XFER_BLK_SS	2048
+
 static struct scsi_cmd usb_ccb __aligned(ARCH_DMA_MINALIGN);
 static __u32 CBWTag;
 
@@ -959,23 +964,31 @@ static void usb_stor_set_max_xfer_blk(struct usb_device *udev,
 				      struct us_data *us)
 {
 	/*
-	 * Limit the total size of a transfer to 120 KB.
+	 * Limit the total size of a transfer to 120 KB (240 sectors), or to
+	 * 1 MB (2048 sectors) for USB3 devices.
 	 *
-	 * Some devices are known to choke with anything larger. It seems like
-	 * the problem stems from the fact that original IDE controllers had
-	 * only an 8-bit register to hold the number of sectors in one transfer
-	 * and even those couldn't handle a full 256 sectors.
+	 * Some devices are known to choke with anything larger than 120 KB.
+	 * It seems like the problem stems from the fact that original IDE
+	 * controllers had only an 8-bit register to hold the number of sectors
+	 * in one transfer and even those couldn't handle a full 256 sectors.
 	 *
 	 * Because we want to make sure we interoperate with as many devices as
-	 * possible, we will maintain a 240 sector transfer size limit for USB
-	 * Mass Storage devices.
+	 * possible, we maintain a 240 sector transfer size limit for USB2 Mass
+	 * Storage devices, and fall back to it for USB3 devices which fail a
+	 * larger transfer.
 	 *
 	 * Tests show that other operating have similar limits with Microsoft
 	 * Windows 7 limiting transfers to 128 sectors for both USB2 and USB3
 	 * and Apple Mac OS X 10.11 limiting transfers to 256 sectors for USB2
 	 * and 2048 for USB3 devices.
+	 *
+	 * Like Mac OS X, start with 2048 sectors on USB3 devices. If such a
+	 * large transfer fails, usb_stor_xfer_fallback() drops back to 240.
 	 */
-	unsigned short blk = 240;
+	unsigned short blk = USB_MAX_XFER_BLK;
+
+	if (udev->speed >= USB_SPEED_SUPER)
+		blk = USB_MAX_XFER_BLK_SS;
 
 #if CONFIG_IS_ENABLED(DM_USB)
 	size_t size;
@@ -989,6 +1002,30 @@ static void usb_stor_set_max_xfer_blk(struct usb_device *udev,
 	us->max_xfer_blk = blk;
 }
 
+/**
+ * usb_stor_xfer_fallback() - Drop back to the conservative transfer size
+ *
+ * The device may still be wedged after stalling the large transfer, so it
+ * gets a transport reset (Bulk-Only reset recovery for BBB devices) before
+ * the caller retries.
+ *
+ * @ss: Storage device on which a transfer failed
+ * @blks: Number of blocks in the failed transfer
+ * Return: true if @blks was above the conservative limit, which is now used
+ * for all further transfers to @ss; false if the limit was already in force
+ */
+static bool usb_stor_xfer_fallback(struct us_data *ss, unsigned short blks)
+{
+	if (blks <= USB_MAX_XFER_BLK)
+		return false;
+
+	debug("Limiting transfers to %d blocks\n", USB_MAX_XFER_BLK);
+	ss->max_xfer_blk = USB_MAX_XFER_BLK;
+	ss->transport_reset(ss);
+
+	return true;
+}
+
 static int usb_inquiry(struct scsi_cmd *srb, struct us_data *ss)
 {
 	int retry, i;
@@ -1203,6 +1240,10 @@ retry_it:
 			debug("Read ERROR\n");
 			ss->flags &= ~USB_READY;
 			usb_request_sense(srb, ss);
+			if (usb_stor_xfer_fallback(ss, smallblks)) {
+				smallblks = ss->max_xfer_blk;
+				goto retry_it;
+			}
 			if (retry--)
 				goto retry_it;
 			blkcnt -= blks;
@@ -1290,6 +1331,10 @@ retry_it:
 			debug("Write ERROR\n");
 			ss->flags &= ~USB_READY;
 			usb_request_sense(srb, ss);
+			if (usb_stor_xfer_fallback(ss, smallblks)) {
+				smallblks = ss->max_xfer_blk;
+				goto retry_it;
+			}
 			if (retry--)
 				goto retry_it;
 			blkcnt -= blks;
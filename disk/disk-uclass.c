@@ -11,6 +11,7 @@
 #include <common.h>
 #include <blk.h>
 #include <dm.h>
+#include <fs.h>
 #include <log.h>
 #include <part.h>
 #include <vsprintf.h>
@@ -91,6 +92,7 @@ static ulong part_blk_read(struct udevice *dev, lbaint_t start,
 static ulong part_blk_write(struct udevice *dev, lbaint_t start,
 			    lbaint_t blkcnt, const void *buffer)
 {
+	struct blk_desc *desc;
 	struct udevice *parent;
 	struct disk_part *part;
 	const struct blk_ops *ops;
@@ -108,12 +110,18 @@ static ulong part_blk_write(struct udevice *dev, lbaint_t start,
 		blkcnt = part->gpt_part_info.size - start;
 	start += part->gpt_part_info.start;
 
+	/* The write bypasses blk_write(), so drop what it would have */
+	desc = dev_get_uclass_plat(parent);
+	gpt_cache_invalidate(desc, start, blkcnt);
+	fs_invalidate(desc);
+
 	return ops->write(parent, start, blkcnt, buffer);
 }
 
 static ulong part_blk_erase(struct udevice *dev, lbaint_t start,
 			    lbaint_t blkcnt)
 {
+	struct blk_desc *desc;
 	struct udevice *parent;
 	struct disk_part *part;
 	const struct blk_ops *ops;
@@ -131,6 +139,11 @@ static ulong part_blk_erase(struct udevice *dev, lbaint_t start,
 		blkcnt = part->gpt_part_info.size - start;
 	start += part->gpt_part_info.start;
 
+	/* The erase bypasses blk_erase(), so drop what it would have */
+	desc = dev_get_uclass_plat(parent);
+	gpt_cache_invalidate(desc, start, blkcnt);
+	fs_invalidate(desc);
+
 	return ops->erase(parent, start, blkcnt);
 }
 
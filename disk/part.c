@@ -9,6 +9,7 @@
 #include <command.h>
 #include <env.h>
 #include <errno.h>
+#include <fs.h>
 #include <ide.h>
 #include <log.h>
 #include <malloc.h>
@@ -227,6 +228,7 @@ void part_init(struct blk_desc *dev_desc)
 	struct part_driver *entry;
 
 	blkcache_invalidate(dev_desc->uclass_id, dev_desc->devnum);
+	gpt_cache_invalidate(dev_desc, 0, 0);
 
 	dev_desc->part_type = PART_TYPE_UNKNOWN;
 	for (entry = drv; entry != drv + n_ents; entry++) {
@@ -208,8 +208,6 @@ int get_disk_guid(struct blk_desc * dev_desc, char *guid)
 	guid_bin = gpt_head->disk_guid.b;
 	uuid_bin_to_str(guid_bin, guid, UUID_STR_FORMAT_GUID);
 
-	/* Remember to free pte */
-	free(gpt_pte);
 	return 0;
 }
 
@@ -249,10 +247,6 @@ void part_print_efi(struct blk_desc *dev_desc)
 		uuid = (unsigned char *)gpt_pte[i].unique_partition_guid.b;
 		printf("\tguid:\t%pUl\n", uuid);
 	}
-
-	/* Remember to free pte */
-	free(gpt_pte);
-	return;
 }
 
 int part_get_info_efi(struct blk_desc *dev_desc, int part,
@@ -274,7 +268,6 @@ int part_get_info_efi(struct blk_desc *dev_desc, int part,
 	if (part > le32_to_cpu(gpt_head->num_partition_entries) ||
 	    !is_pte_valid(&gpt_pte[part - 1])) {
 		log_debug("Invalid partition number %d\n", part);
-		free(gpt_pte);
 		return -EPERM;
 	}
 
@@ -301,8 +294,6 @@ int part_get_info_efi(struct blk_desc *dev_desc, int part,
 	log_debug("start 0x" LBAF ", size 0x" LBAF ", name %s\n", info->start,
 		  info->size, info->name);
 
-	/* Remember to free pte */
-	free(gpt_pte);
 	return 0;
 }
 
@@ -1066,6 +1057,75 @@ static int is_gpt_valid(struct blk_desc *dev_desc, u64 lba,
 	return 1;
 }
 
+/**
+ * struct gpt_cache - A validated GPT kept for a block device
+ *
+ * @sibling: Node in gpt_cache_list
+ * @uclass_id: Uclass ID of the block device
+ * @devnum: Device number of the block device
+ * @hwpart: Hardware partition selected when the GPT was read
+ * @lba: Number of blocks of the device when the GPT was read
+ * @head: Validated GPT header
+ * @pte: Validated partition table entries
+ */
+struct gpt_cache {
+	struct list_head sibling;
+	enum uclass_id uclass_id;
+	int devnum;
+	int hwpart;
+	lbaint_t lba;
+	gpt_header head;
+	gpt_entry *pte;
+};
+
+static LIST_HEAD(gpt_cache_list);
+
+static struct gpt_cache *gpt_cache_find(struct blk_desc *dev_desc)
+{
+	struct gpt_cache *cache;
+
+	list_for_each_entry(cache, &gpt_cache_list, sibling) {
+		if (cache->uclass_id == dev_desc->uclass_id &&
+		    cache->devnum == dev_desc->devnum &&
+		    cache->hwpart == dev_desc->hwpart &&
+		    cache->lba == dev_desc->lba)
+			return cache;
+	}
+
+	return NULL;
+}
+
+static void gpt_cache_free(struct gpt_cache *cache)
+{
+	list_del(&cache->sibling);
+	free(cache->pte);
+	free(cache);
+}
+
+void gpt_cache_invalidate(struct blk_desc *desc, lbaint_t start,
+			  lbaint_t blkcnt)
+{
+	struct gpt_cache *cache, *tmp;
+
+	list_for_each_entry_safe(cache, tmp, &gpt_cache_list, sibling) {
+		if (cache->uclass_id != desc->uclass_id ||
+		    cache->devnum != desc->devnum)
+			continue;
+		if (blkcnt) {
+			/* Another hardware partition is unaffected */
+			if (cache->hwpart != desc->hwpart)
+				continue;
+			if (start >= le64_to_cpu(cache->head.first_usable_lba) &&
+			    start + blkcnt - 1 <=
+			    le64_to_cpu(cache->head.last_usable_lba))
+				continue;
+		}
+		log_debug("Dropping cached GPT for %s %d\n",
+			  blk_get_uclass_name(desc->uclass_id), desc->devnum);
+		gpt_cache_free(cache);
+	}
+}
+
 /**
  * find_valid_gpt() - finds a valid GPT header and PTEs
  *
@@ -1073,13 +1133,28 @@ static int is_gpt_valid(struct blk_desc *dev_desc, u64 lba,
  * ptes is a PTEs ptr, filled on return.
  *
  * Description: returns 1 if found a valid gpt,  0 on error.
- * If valid, returns pointers to PTEs.
+ * If valid, returns pointers to PTEs. These belong to the GPT cache of the
+ * device and must not be freed or modified by the caller.
  */
 static int find_valid_gpt(struct blk_desc *dev_desc, gpt_header *gpt_head,
 			  gpt_entry **pgpt_pte)
 {
+	struct gpt_cache *cache;
 	int r;
 
+	cache = gpt_cache_find(dev_desc);
+	if (cache) {
+		memcpy(gpt_head, &cache->head, sizeof(cache->head));
+		*pgpt_pte = cache->pte;
+		return 1;
+	}
+
+	cache = calloc(1, sizeof(*cache));
+	if (!cache) {
+		log_debug("Can't allocate GPT cache\n");
+		return 0;
+	}
+
 	r = is_gpt_valid(dev_desc, GPT_PRIMARY_PARTITION_TABLE_LBA, gpt_head,
 			 pgpt_pte);
 
@@ -1090,11 +1165,21 @@ static int find_valid_gpt(struct blk_desc *dev_desc, gpt_header *gpt_head,
 		if (is_gpt_valid(dev_desc, (dev_desc->lba - 1), gpt_head,
 				 pgpt_pte) != 1) {
 			log_debug("Invalid Backup GPT\n");
+			free(cache);
 			return 0;
 		}
 		if (r != 2)
 			log_debug("        Using Backup GPT\n");
 	}
+
+	cache->uclass_id = dev_desc->uclass_id;
+	cache->devnum = dev_desc->devnum;
+	cache->hwpart = dev_desc->hwpart;
+	cache->lba = dev_desc->lba;
+	memcpy(&cache->head, gpt_head, sizeof(cache->head));
+	cache->pte = *pgpt_pte;
+	list_add(&cache->sibling, &gpt_cache_list);
+
 	return 1;
 }
 
@@ -9,6 +9,7 @@
 #include <common.h>
 #include <blk.h>
 #include <dm.h>
+#include <fs.h>
 #include <log.h>
 #include <malloc.h>
 #include <part.h>
@@ -474,6 +475,8 @@ long blk_write(struct udevice *dev, lbaint_t start, lbaint_t blkcnt,
 		return -ENOSYS;
 
 	blkcache_invalidate(desc->uclass_id, desc->devnum);
+	gpt_cache_invalidate(desc, start, blkcnt);
+	fs_invalidate(desc);
 
 	return ops->write(dev, start, blkcnt, buf);
 }
@@ -487,6 +490,8 @@ long blk_erase(struct udevice *dev, lbaint_t start, lbaint_t blkcnt)
 		return -ENOSYS;
 
 	blkcache_invalidate(desc->uclass_id, desc->devnum);
+	gpt_cache_invalidate(desc, start, blkcnt);
+	fs_invalidate(desc);
 
 	return ops->erase(dev, start, blkcnt);
 }
@@ -781,9 +786,26 @@ static int blk_post_probe(struct udevice *dev)
 	return 0;
 }
 
+static int blk_pre_remove(struct udevice *dev)
+{
+	fs_invalidate(dev_get_uclass_plat(dev));
+
+	return 0;
+}
+
+static int blk_pre_unbind(struct udevice *dev)
+{
+	/* A new device may get the same descriptor address */
+	fs_invalidate(dev_get_uclass_plat(dev));
+
+	return 0;
+}
+
 UCLASS_DRIVER(blk) = {
 	.id		= UCLASS_BLK,
 	.name		= "blk",
 	.post_probe	= blk_post_probe,
+	.pre_remove	= blk_pre_remove,
+	.pre_unbind	= blk_pre_unbind,
 	.per_device_plat_auto	= sizeof(struct blk_desc),
 };
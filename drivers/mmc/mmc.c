@@ -10,11 +10,13 @@
 #include <config.h>
 #include <common.h>
 #include <blk.h>
+#include <bloblist.h>
 #include <command.h>
 #include <dm.h>
 #include <log.h>
 #include <dm/device-internal.h>
 #include <errno.h>
+#include <fs.h>
 #include <mmc.h>
 #include <part.h>
 #include <linux/bitops.h>
@@ -24,6 +26,7 @@
 #include <memalign.h>
 #include <linux/list.h>
 #include <div64.h>
+#include <spl.h>
 #include "mmc_private.h"
 
 #define TIMEOUT_TEN_MS  10
@@ -399,16 +402,53 @@ int mmc_send_tuning(struct mmc *mmc, u32 opcode, int *cmd_error)
 }
 #endif
 
+bool mmc_can_set_block_count(struct mmc *mmc)
+{
+	if (!(mmc->host_caps & MMC_CAP_CMD23) || mmc_host_is_spi(mmc))
+		return false;
+	if (IS_SD(mmc))
+		return mmc->scr[0] & SD_SCR_CMD23_SUPPORT;
+
+	return mmc->version >= MMC_VERSION_3;
+}
+
+int mmc_set_block_count(struct mmc *mmc, lbaint_t blkcnt, bool reliable)
+{
+	struct mmc_cmd cmd;
+
+	/* eMMC only has 16 bits for the count, the rest are flags */
+	if (!IS_SD(mmc) && blkcnt > 0xffff)
+		return -EINVAL;
+	if (reliable && IS_SD(mmc))
+		return -EINVAL;
+
+	cmd.cmdidx = MMC_CMD_SET_BLOCK_COUNT;
+	cmd.cmdarg = blkcnt;
+	if (reliable)
+		cmd.cmdarg |= 1 << 31;
+	cmd.resp_type = MMC_RSP_R1;
+
+	return mmc_send_cmd(mmc, &cmd, NULL);
+}
+
 static int mmc_read_blocks(struct mmc *mmc, void *dst, lbaint_t start,
 			   lbaint_t blkcnt)
 {
 	struct mmc_cmd cmd;
 	struct mmc_data data;
+	bool stop = false;
 
-	if (blkcnt > 1)
+	if (blkcnt > 1) {
+		if (mmc_can_set_block_count(mmc)) {
+			if (mmc_set_block_count(mmc, blkcnt, false))
+				return 0;
+		} else {
+			stop = true;
+		}
 		cmd.cmdidx = MMC_CMD_READ_MULTIPLE_BLOCK;
-	else
+	} else {
 		cmd.cmdidx = MMC_CMD_READ_SINGLE_BLOCK;
+	}
 
 	if (mmc->high_capacity)
 		cmd.cmdarg = start;
@@ -425,7 +465,7 @@ static int mmc_read_blocks(struct mmc *mmc, void *dst, lbaint_t start,
 	if (mmc_send_cmd(mmc, &cmd, &data))
 		return 0;
 
-	if (blkcnt > 1) {
+	if (stop) {
 		cmd.cmdidx = MMC_CMD_STOP_TRANSMISSION;
 		cmd.cmdarg = 0;
 		cmd.resp_type = MMC_RSP_R1b;
@@ -2452,6 +2492,192 @@ error:
 	return err;
 }
 
+#if IS_ENABLED(CONFIG_MMC_HANDOFF) && CONFIG_IS_ENABLED(DM_MMC)
+/**
+ * mmc_handoff_get() - Find the state SPL recorded for this device
+ *
+ * @mmc: MMC device
+ * Return: hand-off record if this is U-Boot proper and SPL initialised an
+ * eMMC with the same sequence number, else NULL
+ */
+static struct mmc_handoff *mmc_handoff_get(struct mmc *mmc)
+{
+	struct mmc_handoff *ho;
+
+	if (IS_ENABLED(CONFIG_SPL_BUILD) || mmc_host_is_spi(mmc))
+		return NULL;
+
+	ho = bloblist_find(BLOBLISTT_U_BOOT_MMC_HANDOFF, sizeof(*ho));
+	if (!ho || ho->seq != dev_seq(mmc->dev))
+		return NULL;
+
+	return ho;
+}
+
+/**
+ * mmc_handoff_drop() - Stop using the state SPL recorded for this device
+ *
+ * @mmc: MMC device
+ */
+static void mmc_handoff_drop(struct mmc *mmc)
+{
+	struct mmc_handoff *ho = mmc_handoff_get(mmc);
+
+	if (ho)
+		ho->seq = -1;
+}
+
+/**
+ * mmc_handoff_card_changed() - Check the card is the one SPL recorded
+ *
+ * The power cycle is skipped for the card SPL left powered up. If another
+ * card answers, it may have been swapped or reset since, so the record is
+ * dropped and the caller must initialise the card again from power-up.
+ *
+ * @mmc: MMC device, with the CID just read
+ * Return: true if SPL recorded another card, false if it is the same card or
+ * there is no record
+ */
+static bool mmc_handoff_card_changed(struct mmc *mmc)
+{
+	struct mmc_handoff *ho = mmc_handoff_get(mmc);
+
+	if (!ho || !memcmp(ho->cid, mmc->cid, sizeof(ho->cid)))
+		return false;
+	log_debug("Card differs from the one SPL used, power cycling\n");
+	mmc_handoff_drop(mmc);
+
+	return true;
+}
+
+/**
+ * mmc_handoff_update() - Record or retire the SPL hand-off after init
+ *
+ * In SPL this records the eMMC that was just brought up. In U-Boot proper
+ * the record is dropped after the first init of the device, so that a later
+ * 'mmc rescan' does a full power cycle and mode search.
+ *
+ * @mmc: MMC device
+ * @err: Result of the initialisation
+ */
+static void mmc_handoff_update(struct mmc *mmc, int err)
+{
+	struct mmc_handoff *ho;
+
+	if (spl_phase() == PHASE_SPL) {
+		if (err || IS_SD(mmc) || mmc_host_is_spi(mmc))
+			return;
+		ho = bloblist_ensure(BLOBLISTT_U_BOOT_MMC_HANDOFF, sizeof(*ho));
+		if (!ho)
+			return;
+		memcpy(ho->cid, mmc->cid, sizeof(ho->cid));
+		ho->seq = dev_seq(mmc->dev);
+		ho->mode = mmc->selected_mode;
+		ho->bus_width = mmc->bus_width;
+		ho->caps = mmc->card_caps & mmc->host_caps;
+		return;
+	}
+
+	mmc_handoff_drop(mmc);
+}
+
+#if !CONFIG_IS_ENABLED(MMC_TINY)
+/**
+ * mmc_best_mode_caps() - Find the mode and width a full search tries first
+ *
+ * @caps: Capabilities supported by both the card and the host
+ * Return: capability bits of the preferred mode and its widest bus width
+ */
+static uint mmc_best_mode_caps(uint caps)
+{
+	const struct mode_width_tuning *mwt;
+	uint widths;
+
+	for_each_mmc_mode_by_pref(caps, mwt) {
+		widths = mwt->widths & caps;
+		if (widths & MMC_MODE_8BIT)
+			return MMC_CAP(mwt->mode) | MMC_MODE_8BIT;
+		if (widths & MMC_MODE_4BIT)
+			return MMC_CAP(mwt->mode) | MMC_MODE_4BIT;
+		if (widths & MMC_MODE_1BIT)
+			return MMC_CAP(mwt->mode) | MMC_MODE_1BIT;
+	}
+
+	return 0;
+}
+
+/**
+ * mmc_select_handoff_mode() - Try the bus mode SPL settled on
+ *
+ * If SPL recorded this card, only its mode and bus width are tried, so the
+ * faster modes SPL already rejected are not tuned again. This is only done
+ * if SPL could use every mode this phase can, or if the recorded mode is the
+ * best one anyway. SPL is often built without HS200/HS400 support, so
+ * otherwise the full search is needed to reach the faster modes.
+ *
+ * @mmc: MMC device, with the CID and capabilities already read
+ * Return: 0 if the recorded mode was selected, -ve on error (the caller then
+ * does the full mode search)
+ */
+static int mmc_select_handoff_mode(struct mmc *mmc)
+{
+	struct mmc_handoff *ho = mmc_handoff_get(mmc);
+	uint caps, avail;
+
+	if (!ho || memcmp(ho->cid, mmc->cid, sizeof(ho->cid)) ||
+	    ho->mode >= MMC_MODES_END)
+		return -ENOENT;
+
+	caps = MMC_CAP(ho->mode);
+	switch (ho->bus_width) {
+	case 8:
+		caps |= MMC_MODE_8BIT;
+		break;
+	case 4:
+		caps |= MMC_MODE_4BIT;
+		break;
+	case 1:
+		caps |= MMC_MODE_1BIT;
+		break;
+	default:
+		return -EINVAL;
+	}
+	avail = mmc->card_caps & mmc->host_caps;
+	if ((avail & caps) != caps)
+		return -ENOENT;
+	if ((avail & ~ho->caps) && mmc_best_mode_caps(avail) != caps)
+		return -ENOENT;
+	log_debug("Trying mode %d, width %d from SPL\n", ho->mode,
+		  ho->bus_width);
+
+	return mmc_select_mode_and_width(mmc, caps);
+}
+#endif
+#else
+static inline struct mmc_handoff *mmc_handoff_get(struct mmc *mmc)
+{
+	return NULL;
+}
+
+static inline void mmc_handoff_drop(struct mmc *mmc)
+{
+}
+
+static inline bool mmc_handoff_card_changed(struct mmc *mmc)
+{
+	return false;
+}
+
+static inline void mmc_handoff_update(struct mmc *mmc, int err)
+{
+}
+
+static inline int mmc_select_handoff_mode(struct mmc *mmc)
+{
+	return -ENOENT;
+}
+#endif
+
 static int mmc_startup(struct mmc *mmc)
 {
 	int err, i;
@@ -2483,6 +2709,16 @@ static int mmc_startup(struct mmc *mmc)
 
 	memcpy(mmc->cid, cmd.response, 16);
 
+	if (mmc_handoff_card_changed(mmc)) {
+		err = mmc_get_op_cond(mmc, true);
+		if (!err && mmc->op_cond_pending)
+			err = mmc_complete_op_cond(mmc);
+		if (err)
+			return err;
+
+		return mmc_startup(mmc);
+	}
+
 	/*
 	 * For MMC cards, set the Relative Address.
 	 * For SD cards, get the Relatvie Address.
@@ -2633,7 +2869,9 @@ static int mmc_startup(struct mmc *mmc)
 		err = mmc_get_capabilities(mmc);
 		if (err)
 			return err;
-		err = mmc_select_mode_and_width(mmc, mmc->card_caps);
+		err = mmc_select_handoff_mode(mmc);
+		if (err)
+			err = mmc_select_mode_and_width(mmc, mmc->card_caps);
 	}
 #endif
 	if (err)
@@ -2675,6 +2913,8 @@ static int mmc_startup(struct mmc *mmc)
 	bdesc->revision[0] = 0;
 #endif
 
+	/* The card may have been swapped, so forget what was mounted from it */
+	fs_invalidate(bdesc);
 #if !defined(CONFIG_DM_MMC) && (!defined(CONFIG_SPL_BUILD) || defined(CONFIG_SPL_LIBDISK_SUPPORT))
 	part_init(bdesc);
 #endif
@@ -2813,6 +3053,7 @@ static int mmc_power_cycle(struct mmc *mmc)
 int mmc_get_op_cond(struct mmc *mmc, bool quiet)
 {
 	bool uhs_en = supports_uhs(mmc->cfg->host_caps);
+	bool handoff;
 	int err;
 
 	if (mmc->has_init)
@@ -2828,17 +3069,23 @@ int mmc_get_op_cond(struct mmc *mmc, bool quiet)
 		      MMC_QUIRK_RETRY_APP_CMD;
 #endif
 
-	err = mmc_power_cycle(mmc);
-	if (err) {
-		/*
-		 * if power cycling is not supported, we should not try
-		 * to use the UHS modes, because we wouldn't be able to
-		 * recover from an error during the UHS initialization.
-		 */
-		pr_debug("Unable to do a full power cycle. Disabling the UHS modes for safety\n");
-		uhs_en = false;
-		mmc->host_caps &= ~UHS_CAPS;
+	handoff = mmc_handoff_get(mmc);
+	if (handoff) {
+		/* SPL left this eMMC powered up, CMD0 is enough to reset it */
 		err = mmc_power_on(mmc);
+	} else {
+		err = mmc_power_cycle(mmc);
+		if (err) {
+			/*
+			 * if power cycling is not supported, we should not try
+			 * to use the UHS modes, because we wouldn't be able to
+			 * recover from an error during the UHS initialization.
+			 */
+			pr_debug("Unable to do a full power cycle. Disabling the UHS modes for safety\n");
+			uhs_en = false;
+			mmc->host_caps &= ~UHS_CAPS;
+			err = mmc_power_on(mmc);
+		}
 	}
 	if (err)
 		return err;
@@ -2864,7 +3111,7 @@ retry:
 	err = mmc_go_idle(mmc);
 
 	if (err)
-		return err;
+		goto out;
 
 	/* The internal partition reset to user partition(0) at every CMD0 */
 	mmc_get_blk_desc(mmc)->hwpart = 0;
@@ -2886,13 +3133,26 @@ retry:
 
 		if (err) {
 #if !defined(CONFIG_SPL_BUILD) || defined(CONFIG_SPL_LIBCOMMON_SUPPORT)
-			if (!quiet)
+			if (!quiet && !handoff)
 				pr_err("Card did not respond to voltage select! : %d\n", err);
 #endif
-			return -EOPNOTSUPP;
+			err = -EOPNOTSUPP;
 		}
 	}
 
+out:
+	/*
+	 * The card SPL left powered up must still come up as an eMMC. If it
+	 * does not, it was swapped or is in an unknown state, so start again
+	 * with a full power cycle.
+	 */
+	if (handoff && (err || IS_SD(mmc))) {
+		log_debug("Card from SPL did not respond as expected: %d\n",
+			  err);
+		mmc_handoff_drop(mmc);
+		return mmc_get_op_cond(mmc, quiet);
+	}
+
 	return err;
 }
 
@@ -2989,6 +3249,7 @@ int mmc_init(struct mmc *mmc)
 
 	if (!err)
 		err = mmc_complete_init(mmc);
+	mmc_handoff_update(mmc, err);
 	if (err)
 		pr_info("%s: %d, time %lu\n", __func__, err, get_timer(start));
 
@@ -17,6 +17,25 @@ int mmc_poll_for_busy(struct mmc *mmc, int timeout);
 
 int mmc_set_blocklen(struct mmc *mmc, int len);
 
+/**
+ * mmc_can_set_block_count() - Check if multi-block transfers can use CMD23
+ *
+ * @mmc: MMC device
+ * Return: true if both the host and the card support SET_BLOCK_COUNT, so
+ * that no STOP_TRANSMISSION is needed after a multi-block transfer
+ */
+bool mmc_can_set_block_count(struct mmc *mmc);
+
+/**
+ * mmc_set_block_count() - Send CMD23 ahead of a multi-block transfer
+ *
+ * @mmc: MMC device
+ * @blkcnt: Number of blocks in the following transfer
+ * @reliable: Request a reliable write (eMMC only)
+ * Return: 0 if OK, -ve on error
+ */
+int mmc_set_block_count(struct mmc *mmc, lbaint_t blkcnt, bool reliable);
+
 #if CONFIG_IS_ENABLED(BLK)
 ulong mmc_bread(struct udevice *dev, lbaint_t start, lbaint_t blkcnt,
 		void *dst);
@@ -145,6 +145,7 @@ static ulong mmc_write_blocks(struct mmc *mmc, lbaint_t start,
 	struct mmc_cmd cmd;
 	struct mmc_data data;
 	int timeout_ms = 1000;
+	bool set_count = false;
 
 	if ((start + blkcnt) > mmc_get_blk_desc(mmc)->lba) {
 		printf("MMC: block number 0x" LBAF " exceeds max(0x" LBAF ")\n",
@@ -159,6 +160,14 @@ static ulong mmc_write_blocks(struct mmc *mmc, lbaint_t start,
 	else
 		cmd.cmdidx = MMC_CMD_WRITE_MULTIPLE_BLOCK;
 
+	if (blkcnt > 1 && mmc_can_set_block_count(mmc)) {
+		if (mmc_set_block_count(mmc, blkcnt, false)) {
+			printf("mmc fail to set block count\n");
+			return 0;
+		}
+		set_count = true;
+	}
+
 	if (mmc->high_capacity)
 		cmd.cmdarg = start;
 	else
@@ -177,9 +186,10 @@ static ulong mmc_write_blocks(struct mmc *mmc, lbaint_t start,
 	}
 
 	/* SPI multiblock writes terminate using a special
-	 * token, not a STOP_TRANSMISSION request.
+	 * token, not a STOP_TRANSMISSION request. With CMD23 the card stops
+	 * by itself.
 	 */
-	if (!mmc_host_is_spi(mmc) && blkcnt > 1) {
+	if (!mmc_host_is_spi(mmc) && blkcnt > 1 && !set_count) {
 		cmd.cmdidx = MMC_CMD_STOP_TRANSMISSION;
 		cmd.cmdarg = 0;
 		cmd.resp_type = MMC_RSP_R1b;
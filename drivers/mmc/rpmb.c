@@ -75,19 +75,6 @@ struct s_rpmb {
 	unsigned short request;
 };
 
-static int mmc_set_blockcount(struct mmc *mmc, unsigned int blockcount,
-			      bool is_rel_write)
-{
-	struct mmc_cmd cmd = {0};
-
-	cmd.cmdidx = MMC_CMD_SET_BLOCK_COUNT;
-	cmd.cmdarg = blockcount & 0x0000FFFF;
-	if (is_rel_write)
-		cmd.cmdarg |= 1 << 31;
-	cmd.resp_type = MMC_RSP_R1;
-
-	return mmc_send_cmd(mmc, &cmd, NULL);
-}
 static int mmc_rpmb_request(struct mmc *mmc, const struct s_rpmb *s,
 			    unsigned int count, bool is_rel_write)
 {
@@ -96,10 +83,10 @@ static int mmc_rpmb_request(struct mmc *mmc, const struct s_rpmb *s,
 	struct sdhci_host *host = mmc->priv;
 	int ret;
 
-	ret = mmc_set_blockcount(mmc, count, is_rel_write);
+	ret = mmc_set_block_count(mmc, count, is_rel_write);
 	if (ret) {
 #ifdef CONFIG_MMC_RPMB_TRACE
-		printf("%s:mmc_set_blockcount-> %d\n", __func__, ret);
+		printf("%s:mmc_set_block_count-> %d\n", __func__, ret);
 #endif
 		return 1;
 	}
@@ -132,10 +119,10 @@ static int mmc_rpmb_response(struct mmc *mmc, struct s_rpmb *s,
 	struct mmc_data data;
 	int ret;
 
-	ret = mmc_set_blockcount(mmc, 1, false);
+	ret = mmc_set_block_count(mmc, 1, false);
 	if (ret) {
 #ifdef CONFIG_MMC_RPMB_TRACE
-		printf("%s:mmc_set_blockcount-> %d\n", __func__, ret);
+		printf("%s:mmc_set_block_count-> %d\n", __func__, ret);
 #endif
 		return -1;
 	}
@@ -371,7 +358,7 @@ static int rpmb_route_write_req(struct mmc *mmc, struct s_rpmb *req,
 	/*
 	 * Send the write request.
 	 */
-	ret = mmc_set_blockcount(mmc, req_cnt, true);
+	ret = mmc_set_block_count(mmc, req_cnt, true);
 	if (ret)
 		return ret;
 
@@ -382,7 +369,7 @@ static int rpmb_route_write_req(struct mmc *mmc, struct s_rpmb *req,
 	/*
 	 * Read the result of the request.
 	 */
-	ret = mmc_set_blockcount(mmc, 1, false);
+	ret = mmc_set_block_count(mmc, 1, false);
 	if (ret)
 		return ret;
 
@@ -392,7 +379,7 @@ static int rpmb_route_write_req(struct mmc *mmc, struct s_rpmb *req,
 	if (ret)
 		return ret;
 
-	ret = mmc_set_blockcount(mmc, 1, false);
+	ret = mmc_set_block_count(mmc, 1, false);
 	if (ret)
 		return ret;
 
@@ -408,7 +395,7 @@ static int rpmb_route_read_req(struct mmc *mmc, struct s_rpmb *req,
 	/*
 	 * Send the read request.
 	 */
-	ret = mmc_set_blockcount(mmc, 1, false);
+	ret = mmc_set_block_count(mmc, 1, false);
 	if (ret)
 		return ret;
 
@@ -420,7 +407,7 @@ static int rpmb_route_read_req(struct mmc *mmc, struct s_rpmb *req,
 	 * Read the result of the request.
 	 */
 
-	ret = mmc_set_blockcount(mmc, rsp_cnt, false);
+	ret = mmc_set_block_count(mmc, rsp_cnt, false);
 	if (ret)
 		return ret;
 
@@ -31,6 +31,7 @@ struct sandbox_mmc_priv {
 	char *buf;
 	int csize;	/* CSIZE value to report */
 	int size;
+	uint blkcnt;	/* Block count from CMD23, 0 if none */
 };
 
 /**
@@ -45,6 +46,18 @@ static int sandbox_mmc_send_cmd(struct udevice *dev, struct mmc_cmd *cmd,
 	struct sandbox_mmc_priv *priv = dev_get_priv(dev);
 	static ulong erase_start, erase_end;
 
+	/* A block count from CMD23 applies to the next transfer only */
+	if (priv->blkcnt && cmd->cmdidx != MMC_CMD_SET_BLOCK_COUNT) {
+		uint blkcnt = priv->blkcnt;
+
+		priv->blkcnt = 0;
+		if (cmd->cmdidx != MMC_CMD_READ_MULTIPLE_BLOCK &&
+		    cmd->cmdidx != MMC_CMD_WRITE_MULTIPLE_BLOCK)
+			return -EILSEQ;
+		if (!data || data->blocks != blkcnt)
+			return -EIO;
+	}
+
 	switch (cmd->cmdidx) {
 	case MMC_CMD_ALL_SEND_CID:
 		memset(cmd->response, '\0', sizeof(cmd->response));
@@ -78,6 +91,9 @@ static int sandbox_mmc_send_cmd(struct udevice *dev, struct mmc_cmd *cmd,
 			resp[4] = (cmd->cmdarg & 0xF) << 24;
 		break;
 	}
+	case MMC_CMD_SET_BLOCK_COUNT:
+		priv->blkcnt = cmd->cmdarg;
+		break;
 	case MMC_CMD_READ_SINGLE_BLOCK:
 	case MMC_CMD_READ_MULTIPLE_BLOCK:
 		memcpy(data->dest, &priv->buf[cmd->cmdarg * data->blocksize],
@@ -118,7 +134,8 @@ static int sandbox_mmc_send_cmd(struct udevice *dev, struct mmc_cmd *cmd,
 	case SD_CMD_APP_SEND_SCR: {
 		u32 *scr = (u32 *)data->dest;
 
-		scr[0] = cpu_to_be32(2 << 24 | 1 << 15);  /* SD version 3 */
+		/* SD version 3, CMD23 supported */
+		scr[0] = cpu_to_be32(2 << 24 | 1 << 15 | SD_SCR_CMD23_SUPPORT);
 		break;
 	}
 	default:
@@ -157,6 +174,7 @@ static int sandbox_mmc_of_to_plat(struct udevice *dev)
 	ret = mmc_of_parse(dev, cfg);
 	if (ret)
 		return ret;
+	cfg->host_caps |= MMC_CAP_CMD23;
 	blk = mmc_get_blk_desc(&plat->mmc);
 	if (blk)
 		blk->removable = !(cfg->host_caps & MMC_CAP_NONREMOVABLE);
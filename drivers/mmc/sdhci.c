@@ -1007,6 +1007,10 @@ int sdhci_setup_cfg(struct mmc_config *cfg, struct sdhci_host *host,
 	if (caps_1 & SDHCI_SUPPORT_DDR50)
 		cfg->host_caps |= MMC_CAP(UHS_DDR50);
 
+	/* Auto-CMD12 is never enabled, so CMD23 can be used instead */
+	if (!(host->quirks & SDHCI_QUIRK_NO_CMD23))
+		cfg->host_caps |= MMC_CAP_CMD23;
+
 	if (host->host_caps)
 		cfg->host_caps |= host->host_caps;
 
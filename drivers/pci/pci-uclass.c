@@ -853,16 +853,53 @@ __weak extern void board_pci_fixup_dev(struct udevice *bus, struct udevice *dev)
 {
 }
 
+/**
+ * pci_bus_has_one_slot() - Check if a bus can only hold device 0
+ *
+ * The link below a PCIe root port or downstream port is point-to-point, so
+ * only device 0 can be present. Scanning the other 31 device numbers just
+ * costs config reads that fail, which on some controllers means waiting for
+ * a completion timeout.
+ *
+ * @bus: Bus to check
+ * Return: true if only device 0 needs to be scanned
+ */
+static bool pci_bus_has_one_slot(struct udevice *bus)
+{
+	u16 flags;
+	int pos;
+
+	/* The root bus of a controller is not behind a PCIe port */
+	if (!device_is_on_pci_bus(bus))
+		return false;
+
+	pos = dm_pci_find_capability(bus, PCI_CAP_ID_EXP);
+	if (!pos)
+		return false;
+
+	dm_pci_read_config16(bus, pos + PCI_EXP_FLAGS, &flags);
+	switch ((flags & PCI_EXP_FLAGS_TYPE) >> 4) {
+	case PCI_EXP_TYPE_ROOT_PORT:
+	case PCI_EXP_TYPE_DOWNSTREAM:
+	case PCI_EXP_TYPE_PCIE_BRIDGE:
+		return true;
+	default:
+		return false;
+	}
+}
+
 int pci_bind_bus_devices(struct udevice *bus)
 {
 	ulong vendor, device;
 	ulong header_type;
 	pci_dev_t bdf, end;
 	bool found_multi;
+	bool one_slot;
 	int ari_off;
 	int ret;
 
 	found_multi = false;
+	one_slot = pci_bus_has_one_slot(bus);
 	end = PCI_BDF(dev_seq(bus), PCI_MAX_PCI_DEVICES - 1,
 		      PCI_MAX_PCI_FUNCTIONS - 1);
 	for (bdf = PCI_BDF(dev_seq(bus), 0, 0); bdf <= end;
@@ -871,6 +908,9 @@ int pci_bind_bus_devices(struct udevice *bus)
 		struct udevice *dev;
 		ulong class;
 
+		/* ARI functions are reached by following the ARI capability */
+		if (one_slot && PCI_DEV(bdf))
+			break;
 		if (!PCI_FUNC(bdf))
 			found_multi = false;
 		if (PCI_FUNC(bdf) && !found_multi)
@@ -952,6 +992,7 @@ int pci_bind_bus_devices(struct udevice *bus)
 						      PCI_DEV(ari_cap),
 						      PCI_FUNC(ari_cap));
 					bdf = bdf - 0x100;
+					one_slot = false;
 				}
 			}
 		}
@@ -202,14 +202,16 @@ void xhci_cleanup(struct xhci_ctrl *ctrl)
  * Malloc the aligned memory
  *
  * @param size	size of memory to be allocated
+ * @param align	minimum alignment, 0 for the default of one cache line
  * Return: allocates the memory and returns the aligned pointer
  */
-static void *xhci_malloc(unsigned int size)
+static void *xhci_malloc_align(unsigned int size, size_t align)
 {
 	void *ptr;
 	size_t cacheline_size = max(XHCI_ALIGNMENT, CACHELINE_SIZE);
 
-	ptr = memalign(cacheline_size, ALIGN(size, cacheline_size));
+	align = max(align, cacheline_size);
+	ptr = memalign(align, ALIGN(size, cacheline_size));
 	BUG_ON(!ptr);
 	memset(ptr, '\0', size);
 
@@ -218,6 +220,11 @@ static void *xhci_malloc(unsigned int size)
 	return ptr;
 }
 
+static void *xhci_malloc(unsigned int size)
+{
+	return xhci_malloc_align(size, 0);
+}
+
 /**
  * Make the prev segment point to the next segment.
  * Change the last TRB in the prev segment to be a Link TRB which points to the
@@ -293,7 +300,8 @@ static struct xhci_segment *xhci_segment_alloc(struct xhci_ctrl *ctrl)
 	seg = malloc(sizeof(struct xhci_segment));
 	BUG_ON(!seg);
 
-	seg->trbs = xhci_malloc(SEGMENT_SIZE);
+	/* Ring segments must not cross a 64KB boundary (section 6.5) */
+	seg->trbs = xhci_malloc_align(SEGMENT_SIZE, SEGMENT_SIZE);
 	seg->dma = xhci_dma_map(ctrl, seg->trbs, SEGMENT_SIZE);
 
 	seg->next = NULL;
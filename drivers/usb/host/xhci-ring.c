@@ -669,6 +669,12 @@ int xhci_bulk_tx(struct usb_device *udev, unsigned long pipe,
 		running_total += TRB_MAX_BUFF_SIZE;
 	}
 
+	/* The whole TD must fit in the ring, leaving room for the link TRB */
+	if (num_trbs > TRBS_PER_SEGMENT - 1) {
+		debug("XHCI bulk transfer too large (%d bytes)\n", length);
+		return -EINVAL;
+	}
+
 	/*
 	 * XXX: Calling routine prepare_ring() called in place of
 	 * prepare_trasfer() as there in 'Linux' since we are not
@@ -1375,11 +1375,13 @@ static int xhci_update_hub_device(struct udevice *dev, struct usb_device *udev)
 static int xhci_get_max_xfer_size(struct udevice *dev, size_t *size)
 {
 	/*
-	 * xHCD allocates one segment which includes 64 TRBs for each endpoint
-	 * and the last TRB in this segment is configured as a link TRB to form
-	 * a TRB ring. Each TRB can transfer up to 64K bytes, however data
-	 * buffers referenced by transfer TRBs shall not span 64KB boundaries.
-	 * Hence the maximum number of TRBs we can use in one transfer is 62.
+	 * xHCD allocates one segment which includes TRBS_PER_SEGMENT TRBs for
+	 * each endpoint and the last TRB in this segment is configured as a
+	 * link TRB to form a TRB ring. Each TRB can transfer up to 64K bytes,
+	 * however data buffers referenced by transfer TRBs shall not span 64KB
+	 * boundaries, so an unaligned buffer needs one more TRB. Hence the
+	 * maximum number of full TRBs we can use in one transfer is
+	 * TRBS_PER_SEGMENT - 2.
 	 */
 	*size = (TRBS_PER_SEGMENT - 2) * TRB_MAX_BUFF_SIZE;
 
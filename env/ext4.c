@@ -30,6 +30,7 @@
 #include <search.h>
 #include <errno.h>
 #include <ext4fs.h>
+#include <fs.h>
 #include <mmc.h>
 #include <scsi.h>
 #include <asm/global_data.h>
@@ -75,6 +76,8 @@ static int env_ext4_save_buffer(env_t *env_new)
 		return 1;
 
 	dev = dev_desc->devnum;
+	/* The ext4 driver is used directly, so unmount it from the fs layer */
+	fs_invalidate(NULL);
 	ext4fs_set_blk_dev(dev_desc, &info);
 
 	if (!ext4fs_mount(info.size)) {
@@ -158,6 +161,8 @@ static int env_ext4_load(void)
 		goto err_env_relocate;
 
 	dev = dev_desc->devnum;
+	/* The ext4 driver is used directly, so unmount it from the fs layer */
+	fs_invalidate(NULL);
 	ext4fs_set_blk_dev(dev_desc, &info);
 
 	if (!ext4fs_mount(info.size)) {
@@ -15,6 +15,7 @@
 #include <search.h>
 #include <errno.h>
 #include <fat.h>
+#include <fs.h>
 #include <mmc.h>
 #include <scsi.h>
 #include <asm/cache.h>
@@ -109,6 +110,8 @@ static int env_fat_save(void)
 		return 1;
 
 	dev = dev_desc->devnum;
+	/* The FAT driver is used directly, so unmount it from the fs layer */
+	fs_invalidate(NULL);
 	if (fat_set_blk_dev(dev_desc, &info) != 0) {
 		/*
 		 * This printf is embedded in the messages from env_save that
@@ -186,6 +189,8 @@ static int env_fat_load(void)
 		goto err_env_relocate;
 
 	dev = dev_desc->devnum;
+	/* The FAT driver is used directly, so unmount it from the fs layer */
+	fs_invalidate(NULL);
 	if (fat_set_blk_dev(dev_desc, &info) != 0) {
 		/*
 		 * This printf is embedded in the messages from env_save that
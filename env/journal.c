@@ -0,0 +1,325 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Append-only journal of environment changes
+ *
+ * Without the journal every saveenv rewrites the whole environment, even
+ * if a single variable changed. With it, saveenv appends one small record
+ * per changed or deleted variable and only rewrites the environment once
+ * the journal is full. Loading imports the environment as before and then
+ * replays the records on top of it.
+ *
+ * Each record carries the CRC of the environment copy it applies to, so
+ * records left behind by an interrupted rewrite are never replayed.
+ */
+
+#include <common.h>
+#include <env.h>
+#include <env_internal.h>
+#include <errno.h>
+#include <log.h>
+#include <malloc.h>
+#include <search.h>
+#include <asm/cache.h>
+#include <linux/kernel.h>
+#include <linux/string.h>
+#include <u-boot/crc.h>
+
+#define ENV_JOURNAL_MAGIC	0x4a45	/* "EJ" */
+#define ENV_JOURNAL_ERASED	0xff
+#define ENV_JOURNAL_ALIGN	4
+
+/**
+ * struct env_journal_rec - Header of a record in the journal
+ *
+ * The header is followed by @len bytes of data: "name=value" to set a
+ * variable or "name" to delete it, NUL-terminated in both cases. Records
+ * start on ENV_JOURNAL_ALIGN boundaries.
+ *
+ * @magic: ENV_JOURNAL_MAGIC
+ * @len: Length of the data following the header
+ * @base_crc: CRC of the environment copy the record applies to
+ * @crc: CRC32 of the header up to this field and of the data
+ */
+struct env_journal_rec {
+	u16 magic;
+	u16 len;
+	u32 base_crc;
+	u32 crc;
+};
+
+/**
+ * struct env_journal - State of the journal
+ *
+ * @log: Copy of the journal area, erased after @used + @pending
+ * @stored: Environment as stored, i.e. with all written records applied
+ * @next: Environment being appended, becomes @stored once written
+ * @base_crc: CRC of the environment copy the journal belongs to
+ * @used: Bytes of @log holding records on the medium
+ * @pending: Bytes of @log appended but not yet written
+ * @valid: true if @stored and @log match the medium
+ */
+static struct env_journal {
+	u8 *log;
+	char *stored;
+	char *next;
+	u32 base_crc;
+	size_t used;
+	size_t pending;
+	bool valid;
+} journal;
+
+static int journal_alloc(void)
+{
+	if (journal.log)
+		return 0;
+
+	journal.log = memalign(ARCH_DMA_MINALIGN, CONFIG_ENV_JOURNAL_SIZE);
+	journal.stored = malloc(ENV_SIZE);
+	journal.next = malloc(ENV_SIZE);
+	if (!journal.log || !journal.stored || !journal.next) {
+		free(journal.log);
+		free(journal.stored);
+		free(journal.next);
+		journal.log = NULL;
+
+		return -ENOMEM;
+	}
+
+	return 0;
+}
+
+/* Export the environment the same way env_export() does */
+static int journal_export(char *buf)
+{
+	if (hexport_r(&env_htab, '\0', 0, &buf, ENV_SIZE, 0, NULL) < 0) {
+		pr_err("Cannot export environment: errno = %d\n", errno);
+		return -EIO;
+	}
+
+	return 0;
+}
+
+static u32 journal_crc(const struct env_journal_rec *rec, const char *data)
+{
+	u32 crc;
+
+	crc = crc32(0, (const u8 *)rec, offsetof(struct env_journal_rec, crc));
+
+	return crc32(crc, (const u8 *)data, rec->len);
+}
+
+/* Add a record after the pending ones; @len includes the NUL */
+static int journal_add(const char *data, size_t len)
+{
+	size_t off = journal.used + journal.pending;
+	size_t size = ALIGN(sizeof(struct env_journal_rec) + len,
+			    ENV_JOURNAL_ALIGN);
+	struct env_journal_rec rec;
+	u8 *p = journal.log + off;
+
+	if (len > U16_MAX || off + size > CONFIG_ENV_JOURNAL_SIZE)
+		return -ENOSPC;
+
+	rec.magic = ENV_JOURNAL_MAGIC;
+	rec.len = len;
+	rec.base_crc = journal.base_crc;
+	rec.crc = journal_crc(&rec, data);
+
+	memcpy(p, &rec, sizeof(rec));
+	memcpy(p + sizeof(rec), data, len);
+	memset(p + sizeof(rec) + len, 0, size - sizeof(rec) - len);
+	journal.pending += size;
+
+	return 0;
+}
+
+/* Add a record deleting the variable of a "name=value" entry */
+static int journal_del(char *entry)
+{
+	char *eq = strchr(entry, '=');
+	struct env_entry e, *ep;
+	int ret = 0;
+
+	*eq = '\0';
+	e.key = entry;
+	e.data = NULL;
+	/*
+	 * Only delete what is really gone, so that a difference in sort
+	 * order can at worst cause a redundant record, never a lost variable
+	 */
+	hsearch_r(e, ENV_FIND, &ep, &env_htab, 0);
+	if (!ep)
+		ret = journal_add(entry, eq - entry + 1);
+	*eq = '=';
+
+	return ret;
+}
+
+/* Compare the names of two "name=value" entries like hexport_r() sorts */
+static int journal_cmp(const char *a, const char *b)
+{
+	char ca, cb;
+
+	do {
+		ca = *a == '=' ? '\0' : *a++;
+		cb = *b == '=' ? '\0' : *b++;
+	} while (ca && ca == cb);
+
+	return (unsigned char)ca - (unsigned char)cb;
+}
+
+static bool journal_entry(const char *buf, const char *p)
+{
+	return p < buf + ENV_SIZE && *p;
+}
+
+int env_journal_load(u32 base_crc, const void *log, int flags)
+{
+	const size_t hdr = sizeof(struct env_journal_rec);
+	size_t off = 0;
+	int ret;
+
+	journal.valid = false;
+	ret = journal_alloc();
+	if (ret)
+		return ret;
+	memcpy(journal.log, log, CONFIG_ENV_JOURNAL_SIZE);
+
+	while (off + hdr <= CONFIG_ENV_JOURNAL_SIZE) {
+		const char *data = (const char *)journal.log + off + hdr;
+		struct env_journal_rec rec;
+
+		memcpy(&rec, journal.log + off, hdr);
+		if (rec.magic != ENV_JOURNAL_MAGIC ||
+		    rec.base_crc != base_crc || !rec.len ||
+		    off + hdr + rec.len > CONFIG_ENV_JOURNAL_SIZE ||
+		    data[rec.len - 1] || journal_crc(&rec, data) != rec.crc)
+			break;
+
+		if (!himport_r(&env_htab, data, rec.len, '\0',
+			       flags | H_NOCLEAR, 0, 0, NULL))
+			pr_err("Cannot replay \"%s\": errno = %d\n", data,
+			       errno);
+		off += ALIGN(hdr + rec.len, ENV_JOURNAL_ALIGN);
+	}
+	log_debug("replayed %zu bytes of journal\n", off);
+
+	journal.base_crc = base_crc;
+	journal.used = off;
+	journal.pending = 0;
+	ret = journal_export(journal.stored);
+	if (ret)
+		return ret;
+
+	/*
+	 * Appending over anything but erased space would corrupt the new
+	 * records, so in that case the next save rewrites the environment
+	 */
+	if (memchr_inv(journal.log + off, ENV_JOURNAL_ERASED,
+		       CONFIG_ENV_JOURNAL_SIZE - off)) {
+		log_debug("journal not erased after %zu bytes\n", off);
+		return 0;
+	}
+	journal.valid = true;
+
+	return 0;
+}
+
+int env_journal_append(u8 **logp, size_t *offp, size_t *lenp)
+{
+	char *o = journal.stored;
+	char *n = journal.next;
+	int ret;
+
+	if (!journal.valid)
+		return -ENOENT;
+
+	journal.pending = 0;
+	ret = journal_export(journal.next);
+	if (ret)
+		return ret;
+
+	/* Both exports are sorted by name, so one pass finds all changes */
+	while (!ret && (journal_entry(journal.stored, o) ||
+			journal_entry(journal.next, n))) {
+		int cmp;
+
+		if (!journal_entry(journal.stored, o))
+			cmp = 1;
+		else if (!journal_entry(journal.next, n))
+			cmp = -1;
+		else
+			cmp = journal_cmp(o, n);
+
+		if (cmp < 0) {
+			ret = journal_del(o);
+			o += strlen(o) + 1;
+		} else if (cmp > 0) {
+			ret = journal_add(n, strlen(n) + 1);
+			n += strlen(n) + 1;
+		} else {
+			if (strcmp(o, n))
+				ret = journal_add(n, strlen(n) + 1);
+			o += strlen(o) + 1;
+			n += strlen(n) + 1;
+		}
+	}
+	if (ret) {
+		memset(journal.log + journal.used, ENV_JOURNAL_ERASED,
+		       journal.pending);
+		journal.pending = 0;
+
+		return ret;
+	}
+
+	*logp = journal.log;
+	*offp = journal.used;
+	*lenp = journal.pending;
+
+	return 0;
+}
+
+void env_journal_written(int err)
+{
+	char *tmp;
+
+	if (err) {
+		journal.valid = false;
+		return;
+	}
+
+	journal.used += journal.pending;
+	journal.pending = 0;
+	tmp = journal.stored;
+	journal.stored = journal.next;
+	journal.next = tmp;
+}
+
+int env_journal_reset(u8 **logp)
+{
+	int ret;
+
+	journal.valid = false;
+	ret = journal_alloc();
+	if (ret)
+		return ret;
+
+	ret = journal_export(journal.stored);
+	if (ret)
+		return ret;
+
+	journal.base_crc = crc32(0, (u8 *)journal.stored, ENV_SIZE);
+	memset(journal.log, ENV_JOURNAL_ERASED, CONFIG_ENV_JOURNAL_SIZE);
+	journal.used = 0;
+	journal.pending = 0;
+	journal.valid = true;
+	if (logp)
+		*logp = journal.log;
+
+	return 0;
+}
+
+void env_journal_forget(void)
+{
+	journal.valid = false;
+}
@@ -234,6 +234,17 @@ static void fini_mmc_for_env(struct mmc *mmc)
 	mmc_set_env_part_restore(mmc);
 }
 
+#if CONFIG_IS_ENABLED(ENV_JOURNAL)
+/* With one copy in each boot partition, the journal is in the first one */
+static int env_mmc_journal_part(struct mmc *mmc)
+{
+	if (IS_ENABLED(ENV_MMC_HWPART_REDUND))
+		return mmc_set_env_part(mmc, 1);
+
+	return 0;
+}
+#endif
+
 #if defined(CONFIG_CMD_SAVEENV) && !defined(CONFIG_SPL_BUILD)
 static inline int write_env(struct mmc *mmc, unsigned long size,
 			    unsigned long offset, const void *buffer)
@@ -249,7 +260,7 @@ static inline int write_env(struct mmc *mmc, unsigned long size,
 	return (n == blk_cnt) ? 0 : -1;
 }
 
-static int env_mmc_save(void)
+static int env_mmc_save_env(void)
 {
 	ALLOC_CACHE_ALIGN_BUFFER(env_t, env_new, 1);
 	int dev = mmc_get_env_dev();
@@ -302,6 +313,91 @@ fini:
 	return ret;
 }
 
+#if CONFIG_IS_ENABLED(ENV_JOURNAL)
+static int env_mmc_journal_append(void)
+{
+	int dev = mmc_get_env_dev();
+	struct mmc *mmc = find_mmc_device(dev);
+	const char *errmsg;
+	size_t off, len;
+	uint start, end;
+	u8 *log;
+	int ret;
+
+	ret = env_journal_append(&log, &off, &len);
+	if (ret)
+		return ret;
+
+	errmsg = init_mmc_for_env(mmc);
+	if (errmsg) {
+		printf("%s\n", errmsg);
+		env_journal_written(-EIO);
+		return 1;
+	}
+
+	printf("Appending to MMC(%d)... ", dev);
+	ret = env_mmc_journal_part(mmc);
+	if (!ret && len) {
+		start = ALIGN_DOWN(off, mmc->write_bl_len);
+		end = ALIGN(off + len, mmc->write_bl_len);
+		ret = write_env(mmc, end - start,
+				CONFIG_ENV_JOURNAL_OFFSET + start, log + start);
+	}
+	puts(ret ? "failed\n" : "done\n");
+	env_journal_written(ret);
+	fini_mmc_for_env(mmc);
+
+	return ret ? 1 : 0;
+}
+
+static int env_mmc_journal_clear(void)
+{
+	int dev = mmc_get_env_dev();
+	struct mmc *mmc = find_mmc_device(dev);
+	const char *errmsg;
+	u8 *log;
+	int ret;
+
+	errmsg = init_mmc_for_env(mmc);
+	if (errmsg) {
+		printf("%s\n", errmsg);
+		env_journal_forget();
+		return 1;
+	}
+
+	ret = env_journal_reset(&log);
+	if (!ret)
+		ret = env_mmc_journal_part(mmc);
+	if (!ret)
+		ret = write_env(mmc, CONFIG_ENV_JOURNAL_SIZE,
+				CONFIG_ENV_JOURNAL_OFFSET, log);
+	if (ret)
+		env_journal_forget();
+	fini_mmc_for_env(mmc);
+
+	return ret ? 1 : 0;
+}
+#else
+static inline int env_mmc_journal_append(void) { return -ENOENT; }
+static inline int env_mmc_journal_clear(void) { return 0; }
+#endif
+
+static int env_mmc_save(void)
+{
+	int ret;
+
+	ret = env_mmc_journal_append();
+	if (ret != -ENOENT && ret != -ENOSPC)
+		return ret;
+
+	/* Journal full or out of step: rewrite it all and start afresh */
+	ret = env_mmc_save_env();
+	if (ret)
+		return ret;
+
+	return env_mmc_journal_clear();
+}
+
 static inline int erase_env(struct mmc *mmc, unsigned long size,
 			    unsigned long offset)
 {
@@ -359,6 +455,10 @@ static int env_mmc_erase(void)
 		ret |= erase_env(mmc, CONFIG_ENV_SIZE, offset);
 	}
 
+#if CONFIG_IS_ENABLED(ENV_JOURNAL)
+	env_journal_forget();
+#endif
+
 fini:
 	fini_mmc_for_env(mmc);
 	return ret;
@@ -379,6 +479,26 @@ static inline int read_env(struct mmc *mmc, unsigned long size,
 	return (n == blk_cnt) ? 0 : -1;
 }
 
+#if CONFIG_IS_ENABLED(ENV_JOURNAL)
+static void env_mmc_journal_load(struct mmc *mmc, const env_t *ep)
+{
+	void *log;
+
+	log = memalign(ARCH_DMA_MINALIGN, CONFIG_ENV_JOURNAL_SIZE);
+	if (!log)
+		return;
+
+	if (!env_mmc_journal_part(mmc) &&
+	    !read_env(mmc, CONFIG_ENV_JOURNAL_SIZE, CONFIG_ENV_JOURNAL_OFFSET,
+		      log))
+		env_journal_load(ep->crc, log, H_EXTERNAL);
+
+	free(log);
+}
+#else
+static inline void env_mmc_journal_load(struct mmc *mmc, const env_t *ep) {}
+#endif
+
 #if defined(ENV_IS_EMBEDDED)
 static int env_mmc_load(void)
 {
@@ -431,6 +551,9 @@ static int env_mmc_load(void)
 
 	ret = env_import_redund((char *)tmp_env1, read1_fail, (char *)tmp_env2,
 				read2_fail, H_EXTERNAL);
+	if (!ret)
+		env_mmc_journal_load(mmc, gd->env_valid == ENV_VALID ?
+				     tmp_env1 : tmp_env2);
 
 fini:
 	fini_mmc_for_env(mmc);
@@ -474,6 +597,7 @@ static int env_mmc_load(void)
 	if (!ret) {
 		ep = (env_t *)buf;
 		gd->env_addr = (ulong)&ep->data;
+		env_mmc_journal_load(mmc, ep);
 	}
 
 fini:
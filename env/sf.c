@@ -75,8 +75,87 @@ static int setup_flash_device(struct spi_flash **env_flash)
 	return 0;
 }
 
+#if CONFIG_IS_ENABLED(ENV_JOURNAL)
+static int env_sf_journal_erase(struct spi_flash *env_flash)
+{
+	u32 sect_size = CONFIG_ENV_SECT_SIZE;
+
+	if (IS_ENABLED(CONFIG_ENV_SECT_SIZE_AUTO))
+		sect_size = env_flash->mtd.erasesize;
+
+	return spi_flash_erase(env_flash, CONFIG_ENV_JOURNAL_OFFSET,
+			       ALIGN(CONFIG_ENV_JOURNAL_SIZE, sect_size));
+}
+
+static void env_sf_journal_load(struct spi_flash *env_flash, const env_t *ep)
+{
+	void *log;
+
+	log = memalign(ARCH_DMA_MINALIGN, CONFIG_ENV_JOURNAL_SIZE);
+	if (!log)
+		return;
+
+	if (!spi_flash_read(env_flash, CONFIG_ENV_JOURNAL_OFFSET,
+			    CONFIG_ENV_JOURNAL_SIZE, log))
+		env_journal_load(ep->crc, log, H_EXTERNAL);
+
+	free(log);
+}
+
+static int env_sf_journal_append(void)
+{
+	struct spi_flash *env_flash;
+	size_t off, len;
+	u8 *log;
+	int ret;
+
+	ret = env_journal_append(&log, &off, &len);
+	if (ret)
+		return ret;
+
+	ret = setup_flash_device(&env_flash);
+	if (!ret) {
+		puts("Appending to SPI flash...");
+		if (len)
+			ret = spi_flash_write(env_flash,
+					      CONFIG_ENV_JOURNAL_OFFSET + off,
+					      len, log + off);
+		spi_flash_free(env_flash);
+		if (!ret)
+			puts("done\n");
+	}
+	env_journal_written(ret);
+
+	return ret;
+}
+
+static int env_sf_journal_clear(void)
+{
+	struct spi_flash *env_flash;
+	int ret;
+
+	ret = setup_flash_device(&env_flash);
+	if (ret)
+		return ret;
+
+	ret = env_journal_reset(NULL);
+	if (!ret)
+		ret = env_sf_journal_erase(env_flash);
+	if (ret)
+		env_journal_forget();
+	spi_flash_free(env_flash);
+
+	return ret;
+}
+#else
+static inline void env_sf_journal_load(struct spi_flash *env_flash,
+				       const env_t *ep) {}
+static inline int env_sf_journal_append(void) { return -ENOENT; }
+static inline int env_sf_journal_clear(void) { return 0; }
+#endif
+
 #if defined(CONFIG_ENV_OFFSET_REDUND)
-static int env_sf_save(void)
+static int env_sf_save_env(void)
 {
 	env_t	env_new;
 	char	*saved_buffer = NULL, flag = ENV_REDUND_OBSOLETE;
@@ -190,6 +269,9 @@ static int env_sf_load(void)
 
 	ret = env_import_redund((char *)tmp_env1, read1_fail, (char *)tmp_env2,
 				read2_fail, H_EXTERNAL);
+	if (!ret)
+		env_sf_journal_load(env_flash, gd->env_valid == ENV_VALID ?
+				    tmp_env1 : tmp_env2);
 
 	spi_flash_free(env_flash);
 out:
@@ -199,7 +281,7 @@ out:
 	return ret;
 }
 #else
-static int env_sf_save(void)
+static int env_sf_save_env(void)
 {
 	u32	saved_size = 0, saved_offset = 0, sector;
 	u32	sect_size = CONFIG_ENV_SECT_SIZE;
@@ -290,8 +372,10 @@ static int env_sf_load(void)
 	}
 
 	ret = env_import(buf, 1, H_EXTERNAL);
-	if (!ret)
+	if (!ret) {
 		gd->env_valid = ENV_VALID;
+		env_sf_journal_load(env_flash, (env_t *)buf);
+	}
 
 err_read:
 	spi_flash_free(env_flash);
@@ -302,6 +386,22 @@ out:
 }
 #endif
 
+static int env_sf_save(void)
+{
+	int ret;
+
+	ret = env_sf_journal_append();
+	if (ret != -ENOENT && ret != -ENOSPC)
+		return ret;
+
+	/* Journal full or out of step: rewrite it all and start afresh */
+	ret = env_sf_save_env();
+	if (ret)
+		return ret;
+
+	return env_sf_journal_clear();
+}
+
 static int env_sf_erase(void)
 {
 	int ret;
@@ -320,6 +420,12 @@ static int env_sf_erase(void)
 	if (ENV_OFFSET_REDUND != OFFSET_INVALID)
 		ret = spi_flash_write(env_flash, ENV_OFFSET_REDUND, CONFIG_ENV_SIZE, &env);
 
+#if CONFIG_IS_ENABLED(ENV_JOURNAL)
+	env_journal_forget();
+	if (!ret)
+		ret = env_sf_journal_erase(env_flash);
+#endif
+
 done:
 	spi_flash_free(env_flash);
 
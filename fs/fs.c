@@ -37,10 +37,29 @@ static int fs_dev_part;
 static struct disk_partition fs_partition;
 static int fs_type = FS_TYPE_ANY;
 
-void fs_set_type(int type)
-{
-	fs_type = type;
-}
+/**
+ * struct fs_mount - Filesystem kept mounted after fs_close()
+ *
+ * @desc: Block device of the filesystem
+ * @part: Partition number
+ * @hwpart: Hardware partition selected on @desc
+ * @start: First block of the partition
+ * @size: Number of blocks in the partition
+ * @fstype: Filesystem type (FS_TYPE_...), FS_TYPE_ANY if nothing is mounted
+ * @disabled: true to close the filesystem after each operation
+ * @hits: Number of times the mounted filesystem was used again
+ */
+static struct fs_mount {
+	struct blk_desc *desc;
+	int part;
+	int hwpart;
+	lbaint_t start;
+	lbaint_t size;
+	int fstype;
+	bool disabled;
+	ulong hits;
+} fs_mount;
+
 
 static inline int fs_probe_unsupported(struct blk_desc *fs_dev_desc,
 				      struct disk_partition *fs_partition)
@@ -416,6 +435,84 @@ const char *fs_get_type_name(void)
 	return fs_get_info(fs_type)->name;
 }
 
+static bool fs_mount_matches(int fstype, int part)
+{
+	if (fs_mount.fstype == FS_TYPE_ANY ||
+	    (fstype != FS_TYPE_ANY && fstype != fs_mount.fstype))
+		return false;
+
+	return fs_mount.desc == fs_dev_desc && fs_mount.part == part &&
+		(!fs_dev_desc || fs_mount.hwpart == fs_dev_desc->hwpart) &&
+		fs_mount.start == fs_partition.start &&
+		fs_mount.size == fs_partition.size;
+}
+
+/* Use the filesystem still mounted on the partition, if any */
+static bool fs_mount_reuse(int fstype, int part)
+{
+	if (!CONFIG_IS_ENABLED(FS_MOUNT_CACHE) || !fs_mount_matches(fstype, part))
+		return false;
+
+	fs_type = fs_mount.fstype;
+	fs_dev_part = part;
+	fs_mount.hits++;
+
+	return true;
+}
+
+/* Remember the filesystem just probed so fs_close() can keep it mounted */
+static void fs_mount_set(struct fstype_info *info, int part)
+{
+	if (!CONFIG_IS_ENABLED(FS_MOUNT_CACHE) || fs_mount.disabled ||
+	    info->null_dev_desc_ok)
+		return;
+
+	fs_mount.desc = fs_dev_desc;
+	fs_mount.part = part;
+	fs_mount.hwpart = fs_dev_desc ? fs_dev_desc->hwpart : 0;
+	fs_mount.start = fs_partition.start;
+	fs_mount.size = fs_partition.size;
+	fs_mount.fstype = info->fstype;
+}
+
+/* Unmount the filesystem kept mounted, unless it is in use */
+static void fs_mount_drop(void)
+{
+	int fstype = fs_mount.fstype;
+
+	if (fstype == FS_TYPE_ANY)
+		return;
+	fs_mount.fstype = FS_TYPE_ANY;
+	if (fs_type == FS_TYPE_ANY)
+		fs_get_info(fstype)->close();
+}
+
+void fs_set_type(int type)
+{
+	fs_mount_drop();
+	fs_type = type;
+}
+
+#if CONFIG_IS_ENABLED(FS_MOUNT_CACHE)
+void fs_invalidate(struct blk_desc *desc)
+{
+	if (!desc || desc == fs_mount.desc)
+		fs_mount_drop();
+}
+
+void fs_mount_cache_enable(bool enable)
+{
+	fs_mount.disabled = !enable;
+	if (!enable)
+		fs_mount_drop();
+}
+
+ulong fs_mount_get_hits(void)
+{
+	return fs_mount.hits;
+}
+#endif
+
 int fs_set_blk_dev(const char *ifname, const char *dev_part_str, int fstype)
 {
 	struct fstype_info *info;
@@ -441,6 +538,9 @@ int fs_set_blk_dev(const char *ifname, const char *dev_part_str, int fstype)
 						    &fs_partition, 1);
 	if (part < 0)
 		return -1;
+	if (fs_mount_reuse(fstype, part))
+		return 0;
+	fs_mount_drop();
 
 	for (i = 0, info = fstypes; i < ARRAY_SIZE(fstypes); i++, info++) {
 		if (fstype != FS_TYPE_ANY && info->fstype != FS_TYPE_ANY &&
@@ -453,6 +553,7 @@ int fs_set_blk_dev(const char *ifname, const char *dev_part_str, int fstype)
 		if (!info->probe(fs_dev_desc, &fs_partition)) {
 			fs_type = info->fstype;
 			fs_dev_part = part;
+			fs_mount_set(info, part);
 			return 0;
 		}
 	}
@@ -473,11 +574,15 @@ int fs_set_blk_dev_with_part(struct blk_desc *desc, int part)
 	if (ret)
 		return ret;
 	fs_dev_desc = desc;
+	if (fs_mount_reuse(FS_TYPE_ANY, part))
+		return 0;
+	fs_mount_drop();
 
 	for (i = 0, info = fstypes; i < ARRAY_SIZE(fstypes); i++, info++) {
 		if (!info->probe(fs_dev_desc, &fs_partition)) {
 			fs_type = info->fstype;
 			fs_dev_part = part;
+			fs_mount_set(info, part);
 			return 0;
 		}
 	}
@@ -489,7 +594,9 @@ void fs_close(void)
 {
 	struct fstype_info *info = fs_get_info(fs_type);
 
-	info->close();
+	/* Keep the filesystem mounted for the next operation on it */
+	if (!CONFIG_IS_ENABLED(FS_MOUNT_CACHE) || fs_type != fs_mount.fstype)
+		info->close();
 
 	fs_type = FS_TYPE_ANY;
 }
@@ -627,6 +734,7 @@ int fs_write(const char *filename, ulong addr, loff_t offset, loff_t len,
 		log_err("** Unable to write file %s **\n", filename);
 		ret = -1;
 	}
+	fs_invalidate(fs_dev_desc);
 	fs_close();
 
 	return ret;
@@ -692,6 +800,7 @@ int fs_unlink(const char *filename)
 
 	ret = info->unlink(filename);
 
+	fs_invalidate(fs_dev_desc);
 	fs_close();
 
 	return ret;
@@ -705,6 +814,7 @@ int fs_mkdir(const char *dirname)
 
 	ret = info->mkdir(dirname);
 
+	fs_invalidate(fs_dev_desc);
 	fs_close();
 
 	return ret;
@@ -721,6 +831,7 @@ int fs_ln(const char *fname, const char *target)
 		log_err("** Unable to create link %s -> %s **\n", fname, target);
 		ret = -1;
 	}
+	fs_invalidate(fs_dev_desc);
 	fs_close();
 
 	return ret;
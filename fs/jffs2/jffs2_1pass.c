@@ -114,6 +114,7 @@
 #include <common.h>
 #include <config.h>
 #include <malloc.h>
+#include <mapmem.h>
 #include <div64.h>
 #include <linux/compiler.h>
 #include <linux/stat.h>
@@ -380,27 +381,35 @@ static void put_fl_mem_onenand(void *buf)
 
 
 #if defined(CONFIG_CMD_FLASH)
+#if defined(CONFIG_MTD_NOR_FLASH)
 #include <flash.h>
+#endif
 
 /*
  * Support for jffs2 on top of NOR-flash
  *
  * NOR flash memory is mapped in processor's address space,
- * just return address.
+ * just return address. Without a NOR flash driver the offset is
+ * taken to be the address itself.
  */
 static inline void *get_fl_mem_nor(u32 off, u32 size, void *ext_buf)
 {
-	u32 addr = off;
+	ulong addr = off;
+	void *ptr;
+#if defined(CONFIG_MTD_NOR_FLASH)
 	struct mtdids *id = current_part->dev->id;
 
 	flash_info_t *flash = &flash_info[id->num];
 
 	addr += flash->start[0];
+#endif
+	ptr = map_sysmem(addr, size);
 	if (ext_buf) {
-		memcpy(ext_buf, (void *)addr, size);
+		memcpy(ext_buf, ptr, size);
+		unmap_sysmem(ptr);
 		return ext_buf;
 	}
-	return (void*)addr;
+	return ptr;
 }
 
 static inline void *get_node_mem_nor(u32 off, void *ext_buf)
@@ -444,7 +453,7 @@ static inline void *get_fl_mem(u32 off, u32 size, void *ext_buf)
 		printf("get_fl_mem: unknown device type, " \
 			"using raw offset!\n");
 	}
-	return (void*)off;
+	return map_sysmem(off, 0);
 }
 
 static inline void *get_node_mem(u32 off, void *ext_buf)
@@ -472,7 +481,7 @@ static inline void *get_node_mem(u32 off, void *ext_buf)
 		printf("get_fl_mem: unknown device type, " \
 			"using raw offset!\n");
 	}
-	return (void*)off;
+	return map_sysmem(off, 0);
 }
 
 static inline void put_fl_mem(void *buf, void *ext_buf)
@@ -655,6 +664,7 @@ jffs2_free_cache(struct part_info *part)
 		free_nodes(&pL->dir);
 		free(pL->readbuf);
 		free(pL);
+		part->jffs2_priv = NULL;
 	}
 }
 
@@ -1255,7 +1265,7 @@ static u16 sum_get_unaligned16(u16 *ptr)
 	return __le16_to_cpu(val);
 }
 
-#define dbg_summary(...) do {} while (0);
+#define dbg_summary(...) do {} while (0)
 /*
  * Process the stored summary information - helper function for
  * jffs2_sum_scan_sumnode()
@@ -1263,7 +1273,7 @@ static u16 sum_get_unaligned16(u16 *ptr)
 
 static int jffs2_sum_process_sum_data(struct part_info *part, uint32_t offset,
 				struct jffs2_raw_summary *summary,
-				struct b_lists *pL)
+				struct b_lists *pL, u32 *max_totlen)
 {
 	void *sp;
 	int i, pass;
@@ -1294,6 +1304,9 @@ static int jffs2_sum_process_sum_data(struct part_info *part, uint32_t offset,
 						b->ino = sum_get_unaligned32(
 							&spi->inode);
 						b->datacrc = CRC_UNKNOWN;
+						*max_totlen = max(*max_totlen,
+							sum_get_unaligned32(
+								&spi->totlen));
 					}
 
 					sp += JFFS2_SUMMARY_INODE_SIZE;
@@ -1316,6 +1329,9 @@ static int jffs2_sum_process_sum_data(struct part_info *part, uint32_t offset,
 						b->pino = sum_get_unaligned32(
 							&spd->pino);
 						b->datacrc = CRC_UNKNOWN;
+						*max_totlen = max(*max_totlen,
+							sum_get_unaligned32(
+								&spd->totlen));
 					}
 
 					sp += JFFS2_SUMMARY_DIRENT_SIZE(
@@ -1340,10 +1356,11 @@ static int jffs2_sum_process_sum_data(struct part_info *part, uint32_t offset,
 	return 0;
 }
 
-/* Process the summary node - called from jffs2_scan_eraseblock() */
-int jffs2_sum_scan_sumnode(struct part_info *part, uint32_t offset,
-			   struct jffs2_raw_summary *summary, uint32_t sumsize,
-			   struct b_lists *pL)
+/* Process the summary node - called from jffs2_1pass_build_lists() */
+static int jffs2_sum_scan_sumnode(struct part_info *part, uint32_t offset,
+				  struct jffs2_raw_summary *summary,
+				  uint32_t sumsize, struct b_lists *pL,
+				  u32 *max_totlen)
 {
 	struct jffs2_unknown_node crcnode;
 	int ret, __maybe_unused ofs;
@@ -1390,7 +1407,7 @@ int jffs2_sum_scan_sumnode(struct part_info *part, uint32_t offset,
 	if (summary->cln_mkr)
 		dbg_summary("Summary : CLEANMARKER node \n");
 
-	ret = jffs2_sum_process_sum_data(part, offset, summary, pL);
+	ret = jffs2_sum_process_sum_data(part, offset, summary, pL, max_totlen);
 	if (ret == -EBADMSG)
 		return 0;
 	if (ret)
@@ -1535,7 +1552,8 @@ jffs2_1pass_build_lists(struct part_info * part)
 				buf_len, buf_len, buf + buf_size - buf_len);
 
 		sm = (void *)buf + buf_size - sizeof(*sm);
-		if (sm->magic == JFFS2_SUM_MAGIC) {
+		if (sm->magic == JFFS2_SUM_MAGIC &&
+		    sm->offset <= part->sector_size - JFFS2_SUMMARY_FRAME_SIZE) {
 			sumlen = part->sector_size - sm->offset;
 			sumptr = buf + buf_size - sumlen;
 
@@ -1565,7 +1583,7 @@ jffs2_1pass_build_lists(struct part_info * part)
 
 		if (sumptr) {
 			ret = jffs2_sum_scan_sumnode(part, sector_ofs, sumptr,
-					sumlen, pL);
+					sumlen, pL, &max_totlen);
 
 			if (buf_size && sumlen > buf_size)
 				free(sumptr);
@@ -484,6 +484,11 @@ struct global_data {
 	 * @cyclic_list: list of registered cyclic functions
 	 */
 	struct hlist_head cyclic_list;
+	/**
+	 * @cyclic_next_us: time in us when the next cyclic function is due;
+	 * 0 forces cyclic_run() to check all of them
+	 */
+	uint64_t cyclic_next_us;
 #endif
 	/**
 	 * @dmtag_list: List of DM tags
@@ -211,6 +211,8 @@ enum bootstage_id {
 	BOOTSTAGE_ID_ACCUM_FSP_M,
 	BOOTSTAGE_ID_ACCUM_FSP_S,
 	BOOTSTAGE_ID_ACCUM_MMAP_SPI,
+	BOOTSTAGE_ID_ACCUM_SPL_FIT_READ,
+	BOOTSTAGE_ID_ACCUM_SPL_FIT_VERIFY,
 
 	/* a few spare for the user, from here */
 	BOOTSTAGE_ID_USER,
@@ -331,6 +333,15 @@ uint32_t bootstage_start(enum bootstage_id id, const char *name);
  */
 uint32_t bootstage_accum(enum bootstage_id id);
 
+/**
+ * bootstage_get_time() - Get the time recorded against a bootstage id
+ *
+ * @id: Bootstage id to look up
+ * Return: time stamp of a mark, or the total time of an accumulator, in
+ *	microseconds; 0 if there is no record for @id
+ */
+ulong bootstage_get_time(enum bootstage_id id);
+
 /* Print a report about boot time */
 void bootstage_report(void);
 
@@ -430,6 +441,11 @@ static inline uint32_t bootstage_accum(enum bootstage_id id)
 	return 0;
 }
 
+static inline ulong bootstage_get_time(enum bootstage_id id)
+{
+	return 0;
+}
+
 static inline int bootstage_stash(void *base, int size)
 {
 	return 0;	/* Pretend to succeed */
@@ -7,6 +7,8 @@
 #ifndef _CLI_HUSH_H_
 #define _CLI_HUSH_H_
 
+#include <linux/types.h>
+
 #define FLAG_EXIT_FROM_LOOP 1
 #define FLAG_PARSE_SEMICOLON (1 << 1)	  /* symbol ';' is special for parser */
 #define FLAG_REPARSING       (1 << 2)	  /* >=2nd pass */
@@ -16,6 +18,16 @@ extern int u_boot_hush_start(void);
 extern int parse_string_outer(const char *, int);
 extern int parse_file_outer(void);
 
+/**
+ * hush_cache_enable() - Turn caching of parsed command strings on or off
+ *
+ * Turning the cache off also drops the scripts in it. This is mostly useful
+ * for comparing the speed of scripts with and without the cache.
+ *
+ * @enable: true to cache parse trees, false to parse every time
+ */
+void hush_cache_enable(bool enable);
+
 int set_local_var(const char *s, int flg_export);
 void unset_local_var(const char *name);
 char *get_local_var(const char *s);
@@ -14,6 +14,12 @@
 #include <linux/list.h>
 #include <asm/types.h>
 
+/*
+ * Number of buckets in the CPU-time histogram: bucket 0 counts executions
+ * below 1us, bucket n those below 4^n us, the last one all longer ones
+ */
+#define CYCLIC_HIST_BUCKETS	8
+
 /**
  * struct cyclic_info - Information about cyclic execution function
  *
@@ -27,6 +33,10 @@
  * @next_call: Next time in us, when the function shall be executed again
  * @list: List node
  * @already_warned: Flag that we've warned about exceeding CPU time usage
+ * @budget_us: Max CPU time in us allowed for one execution
+ * @max_cpu_time_us: Longest CPU time of one execution
+ * @over_budget: Number of executions which took longer than @budget_us
+ * @hist: Number of executions by CPU time, see cyclic_hist_bucket()
  */
 struct cyclic_info {
 	void (*func)(void *ctx);
@@ -39,6 +49,10 @@ struct cyclic_info {
 	uint64_t next_call;
 	struct hlist_node list;
 	bool already_warned;
+	uint budget_us;
+	uint64_t max_cpu_time_us;
+	uint over_budget;
+	uint hist[CYCLIC_HIST_BUCKETS];
 };
 
 /** Function type for cyclic functions */
@@ -65,6 +79,25 @@ struct cyclic_info *cyclic_register(cyclic_func_t func, uint64_t delay_us,
  */
 int cyclic_unregister(struct cyclic_info *cyclic);
 
+/**
+ * cyclic_set_budget() - Set the CPU time allowed for a cyclic function
+ *
+ * Executions taking longer are counted and the first one is reported. The
+ * default is CONFIG_CYCLIC_MAX_CPU_TIME_US.
+ *
+ * @cyclic: Cyclic function to update
+ * @budget_us: Max CPU time in us for one execution
+ */
+void cyclic_set_budget(struct cyclic_info *cyclic, uint budget_us);
+
+/**
+ * cyclic_hist_bucket() - Get the histogram bucket for a CPU time
+ *
+ * @cpu_time_us: CPU time of one execution in us
+ * Return: index into &struct cyclic_info.hist
+ */
+int cyclic_hist_bucket(uint64_t cpu_time_us);
+
 /**
  * cyclic_unregister_all() - Clean up cyclic functions
  *
@@ -85,7 +118,8 @@ struct hlist_head *cyclic_get_list(void);
  * cyclic_run() - Interate over all registered cyclic functions
  *
  * Interate over all registered cyclic functions and if the it's function
- * needs to be executed, then call into these registered functions.
+ * needs to be executed, then call into these registered functions. Returns
+ * straight away if none of them is due yet.
  */
 void cyclic_run(void);
 
@@ -110,6 +144,11 @@ static inline int cyclic_unregister(struct cyclic_info *cyclic)
 	return 0;
 }
 
+static inline void cyclic_set_budget(struct cyclic_info *cyclic,
+				     uint budget_us)
+{
+}
+
 static inline void cyclic_run(void)
 {
 }
@@ -1483,6 +1483,40 @@ struct efi_simple_network_mode {
 #define EFI_SIMPLE_NETWORK_COMMAND_INTERRUPT	0x04
 #define EFI_SIMPLE_NETWORK_SOFTWARE_INTERRUPT	0x08
 
+/**
+ * struct efi_network_statistics - statistics of a network interface
+ *
+ * A value of all ones marks a statistic which is not collected.
+ */
+struct efi_network_statistics {
+	u64 rx_total_frames;
+	u64 rx_good_frames;
+	u64 rx_undersize_frames;
+	u64 rx_oversize_frames;
+	u64 rx_dropped_frames;
+	u64 rx_unicast_frames;
+	u64 rx_broadcast_frames;
+	u64 rx_multicast_frames;
+	u64 rx_crc_error_frames;
+	u64 rx_total_bytes;
+	u64 tx_total_frames;
+	u64 tx_good_frames;
+	u64 tx_undersize_frames;
+	u64 tx_oversize_frames;
+	u64 tx_dropped_frames;
+	u64 tx_unicast_frames;
+	u64 tx_broadcast_frames;
+	u64 tx_multicast_frames;
+	u64 tx_crc_error_frames;
+	u64 tx_total_bytes;
+	u64 collisions;
+	u64 unsupported_protocol;
+	u64 rx_duplicated_frames;
+	u64 rx_decrypt_error_frames;
+	u64 tx_error_frames;
+	u64 tx_retry_frames;
+};
+
 /* revision of the simple network protocol */
 #define EFI_SIMPLE_NETWORK_PROTOCOL_REVISION	0x00010000
 
@@ -14,12 +14,14 @@
 #include <log.h>
 #include <part_efi.h>
 #include <efi_api.h>
+#include <hash.h>
 #include <image.h>
 #include <pe.h>
 #include <linux/list.h>
 #include <linux/oid_registry.h>
 
 struct blk_desc;
+struct efi_image_regions;
 struct jmp_buf_data;
 
 static inline int guidcmp(const void *g1, const void *g2)
@@ -561,6 +563,7 @@ efi_status_t efi_riscv_register(void);
 efi_status_t efi_tcg2_do_initial_measurement(void);
 /* measure the pe-coff image, extend PCR and add Event Log */
 efi_status_t tcg2_measure_pe_image(void *efi, u64 efi_size,
+				   struct efi_image_regions *regs,
 				   struct efi_loaded_image_obj *handle,
 				   struct efi_loaded_image *loaded_image_info);
 /* Create handles and protocols for the partitions of a block device */
@@ -774,6 +777,8 @@ efi_status_t efi_setup_loaded_image(struct efi_device_path *device_path,
 #ifdef CONFIG_EFI_LOADER_BOUNCE_BUFFER
 extern void *efi_bounce_buffer;
 #define EFI_LOADER_BOUNCE_BUFFER_SIZE (64 * 1024 * 1024)
+/* Highest address reachable by DMA, the bounce buffer is placed below it */
+#define EFI_LOADER_BOUNCE_BUFFER_LIMIT 0xffffffffUL
 #endif
 
 /* shorten device path */
@@ -919,16 +924,36 @@ efi_status_t efi_set_load_options(efi_handle_t handle,
 				  void *load_options);
 efi_status_t efi_bootmgr_load(efi_handle_t *handle, void **load_options);
 
+/* Number of digests of an image kept in struct efi_image_regions */
+#define EFI_IMAGE_MAX_DIGESTS	4
+
+/**
+ * struct efi_image_digest - A digest over a list of memory regions
+ *
+ * @algo:	Name of the hash algorithm, e.g. "sha256"
+ * @len:	Length of the digest
+ * @value:	Digest
+ */
+struct efi_image_digest {
+	const char		*algo;
+	int			len;
+	u8			value[HASH_MAX_DIGEST_SIZE];
+};
+
 /**
  * struct efi_image_regions - A list of memory regions
  *
  * @max:	Maximum number of regions
  * @num:	Number of regions
+ * @num_digests:	Number of digests in @digests
+ * @digests:	Digests of the regions computed so far, see efi_image_hash()
  * @reg:	array of regions
  */
 struct efi_image_regions {
 	int			max;
 	int			num;
+	int			num_digests;
+	struct efi_image_digest	digests[EFI_IMAGE_MAX_DIGESTS];
 	struct image_region	reg[];
 };
 
@@ -1020,6 +1045,11 @@ void *efi_prepare_aligned_image(void *efi, u64 *efi_size);
 bool efi_image_parse(void *efi, size_t len, struct efi_image_regions **regp,
 		     WIN_CERTIFICATE **auth, size_t *auth_len);
 
+int efi_image_hash(struct efi_image_regions *regs, const char *const algos[],
+		   int count);
+const u8 *efi_image_digest(struct efi_image_regions *regs, const char *algo,
+			   int *len);
+
 struct pkcs7_message *efi_parse_pkcs7_header(const void *buf,
 					     size_t buflen,
 					     u8 **tmpbuf);
@@ -260,6 +260,61 @@ const char *env_fat_get_intf(void);
  * Return: string of device and partition
  */
 char *env_fat_get_dev_part(void);
+
+/**
+ * env_journal_load() - Replay the environment journal
+ *
+ * Call this after importing the environment copy @base_crc belongs to. The
+ * records for that copy are applied on top of it and the journal is set up
+ * for the next save.
+ *
+ * @base_crc: CRC of the imported environment copy
+ * @log: Contents of the journal area, CONFIG_ENV_JOURNAL_SIZE bytes
+ * @flags: Flags for himport_r(), e.g. H_EXTERNAL
+ * Return: 0 if OK, -ve on error
+ */
+int env_journal_load(u32 base_crc, const void *log, int flags);
+
+/**
+ * env_journal_append() - Add records for the variables changed since the
+ * last save
+ *
+ * The driver writes @len bytes at @off of the journal and then reports the
+ * result with env_journal_written(). @len is 0 if nothing changed.
+ *
+ * @logp: Returns the in-memory copy of the whole journal area
+ * @offp: Returns the offset of the new records in the journal
+ * @lenp: Returns the length of the new records
+ * Return: 0 if OK, -ENOSPC if the journal is full, -ENOENT if the journal
+ * does not match the medium; in both cases the driver should save the
+ * whole environment and call env_journal_reset(). Other -ve on error
+ */
+int env_journal_append(u8 **logp, size_t *offp, size_t *lenp);
+
+/**
+ * env_journal_written() - Finish env_journal_append()
+ *
+ * @err: 0 if the records were written, else the journal is dropped
+ */
+void env_journal_written(int err);
+
+/**
+ * env_journal_reset() - Start an empty journal after a full save
+ *
+ * The driver must then clear the journal area on the medium, e.g. by
+ * erasing it or by writing back the erased copy returned in @logp.
+ *
+ * @logp: If not NULL, returns the in-memory copy of the journal area
+ * Return: 0 if OK, -ve on error
+ */
+int env_journal_reset(u8 **logp);
+
+/**
+ * env_journal_forget() - Drop the journal state
+ *
+ * The next save writes the whole environment.
+ */
+void env_journal_forget(void);
 #endif /* DO_DEPS_ONLY */
 
 #endif /* _ENV_INTERNAL_H_ */
@@ -88,9 +88,54 @@ int fs_set_blk_dev_with_part(struct blk_desc *desc, int part);
  * Many file functions implicitly call fs_close(), e.g. fs_closedir(),
  * fs_exist(), fs_ln(), fs_ls(), fs_mkdir(), fs_read(), fs_size(), fs_write(),
  * fs_unlink().
+ *
+ * With CONFIG_FS_MOUNT_CACHE the filesystem stays mounted, so that selecting
+ * the same partition again does not need to probe it.
  */
 void fs_close(void);
 
+#if CONFIG_IS_ENABLED(FS_MOUNT_CACHE)
+/**
+ * fs_invalidate() - Unmount a filesystem kept mounted by fs_close()
+ *
+ * This must be called when the blocks of a device change other than through
+ * the filesystem layer, e.g. when they are written or the device is removed,
+ * and before using a filesystem driver directly.
+ *
+ * @desc: Block device, or NULL for any
+ */
+void fs_invalidate(struct blk_desc *desc);
+
+/**
+ * fs_mount_cache_enable() - Enable or disable keeping filesystems mounted
+ *
+ * @enable: true to keep the last filesystem mounted after fs_close(), false
+ *	to unmount it after each operation
+ */
+void fs_mount_cache_enable(bool enable);
+
+/**
+ * fs_mount_get_hits() - Get the number of times a mounted filesystem was
+ * used again instead of being probed
+ *
+ * Return: number of hits since U-Boot started
+ */
+ulong fs_mount_get_hits(void);
+#else
+static inline void fs_invalidate(struct blk_desc *desc)
+{
+}
+
+static inline void fs_mount_cache_enable(bool enable)
+{
+}
+
+static inline ulong fs_mount_get_hits(void)
+{
+	return 0;
+}
+#endif
+
 /**
  * fs_get_type() - Get type of current filesystem
  *
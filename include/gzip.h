@@ -23,6 +23,9 @@ int gzip_parse_header(const unsigned char *src, unsigned long len);
 /**
  * gunzip() - Decompress gzipped data
  *
+ * If @src holds several gzip members back to back, they are all decompressed
+ * and their output is concatenated.
+ *
  * @dst: Destination for uncompressed data
  * @dstlen: Size of destination buffer
  * @src: Source data to decompress
@@ -1932,6 +1932,26 @@ int board_fit_config_name_match(const char *name);
 void board_fit_image_post_process(const void *fit, int node, void **p_image,
 				  size_t *p_size);
 
+/**
+ * board_fit_image_load_progress() - Look at FIT image data while it is loaded
+ *
+ * SPL calls this as it reads external image data: first with @loaded equal to
+ * 0 before anything is read, then each time more of the data is in memory,
+ * ending with @loaded equal to @size. A board can use it to work on the data
+ * while it is still in cache, e.g. to hash it ahead of
+ * board_fit_image_post_process(). Calls for one image always pass the same
+ * @image and a @loaded that does not decrease.
+ *
+ * @fit: pointer to fit image
+ * @node: offset of image node
+ * @image: start of the image data
+ * @loaded: number of bytes at the start of @image which are now loaded
+ * @size: size of the image data
+ */
+void board_fit_image_load_progress(const void *fit, int node,
+				   const void *image, size_t loaded,
+				   size_t size);
+
 #define FDT_ERROR	((ulong)(-1))
 
 ulong fdt_getprop_u32(const void *fdt, int node, const char *prop);
@@ -396,6 +396,8 @@ enum log_rec_flags {
  * @file: Name of file where the log record was generated (not allocated)
  * @func: Function where the log record was generated (not allocated)
  * @msg: Log message (allocated)
+ * @fmt: Format string of the message (not allocated)
+ * @args: Arguments for @fmt; devices with LOGDF_RAW must va_copy() them
  */
 struct log_rec {
 	enum log_category_t cat;
@@ -405,12 +407,15 @@ struct log_rec {
 	const char *file;
 	const char *func;
 	const char *msg;
+	const char *fmt;
+	va_list *args;
 };
 
 struct log_device;
 
 enum log_device_flags {
 	LOGDF_ENABLE		= BIT(0),	/* Device is enabled */
+	LOGDF_RAW		= BIT(1),	/* Device uses fmt/args, not msg */
 };
 
 /**
@@ -670,6 +675,32 @@ static inline int log_init(void)
 }
 #endif
 
+/**
+ * log_ring_setup() - Set up the buffer for the ring log driver
+ *
+ * If @buf already holds a ring written by this U-Boot image, e.g. before a
+ * warm reset, its records are kept. Otherwise it is cleared.
+ *
+ * @buf: Buffer to use, or NULL for the default (CONFIG_LOG_RING_ADDR or
+ *	a buffer from malloc())
+ * @size: Size of @buf in bytes, ignored if @buf is NULL
+ * Return: 0 if OK, -EINVAL if @size is too small, -ENOMEM if out of memory
+ */
+int log_ring_setup(void *buf, ulong size);
+
+/**
+ * log_ring_dump() - Format and print the records in the log ring
+ *
+ * The records are printed using the current log format (gd->log_fmt), each
+ * line prefixed by its timestamp.
+ */
+void log_ring_dump(void);
+
+/**
+ * log_ring_clear() - Drop all records from the log ring
+ */
+void log_ring_clear(void);
+
 /**
  * log_get_default_format() - get default log format
  *
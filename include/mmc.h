@@ -74,6 +74,7 @@ struct bd_info;
 #define MMC_CAP_NONREMOVABLE	BIT(14)
 #define MMC_CAP_NEEDS_POLL	BIT(15)
 #define MMC_CAP_CD_ACTIVE_HIGH  BIT(16)
+#define MMC_CAP_CMD23		BIT(17)	/* Host can use CMD23 before transfers */
 
 #define MMC_MODE_8BIT		BIT(30)
 #define MMC_MODE_4BIT		BIT(29)
@@ -82,6 +83,7 @@ struct bd_info;
 
 
 #define SD_DATA_4BIT	0x00040000
+#define SD_SCR_CMD23_SUPPORT	BIT(1)
 
 #define IS_SD(x)	((x)->version & SD_VERSION_SD)
 #define IS_MMC(x)	((x)->version & MMC_VERSION_MMC)
@@ -652,6 +654,28 @@ static inline bool supports_uhs(uint caps)
 #endif
 }
 
+/**
+ * struct mmc_handoff - eMMC state passed from SPL to U-Boot proper
+ *
+ * This is stored in the bloblist with tag BLOBLISTT_U_BOOT_MMC_HANDOFF when
+ * SPL has brought up an eMMC device. U-Boot proper uses it to avoid power
+ * cycling the card again and to try the recorded bus mode before searching
+ * all modes. It is only used if the CID read back still matches.
+ *
+ * @cid: Card identification register read by SPL
+ * @seq: Sequence number of the MMC device in SPL
+ * @mode: Bus mode selected by SPL (enum bus_mode)
+ * @bus_width: Bus width selected by SPL (1, 4 or 8)
+ * @caps: Modes and widths supported by both the card and the host in SPL
+ */
+struct mmc_handoff {
+	u32 cid[4];
+	u32 seq;
+	u32 mode;
+	u32 bus_width;
+	u32 caps;
+};
+
 /*
  * With CONFIG_DM_MMC enabled, struct mmc can be accessed from the MMC device
  * with mmc_get_mmc_dev().
@@ -548,6 +548,25 @@ int gpt_verify_partitions(struct blk_desc *dev_desc,
  */
 int get_disk_guid(struct blk_desc *dev_desc, char *guid);
 
+/**
+ * gpt_cache_invalidate() - Drop cached GPT data affected by a write
+ *
+ * The validated GPT of each block device is cached after it is first read.
+ * This must be called when blocks of the device are written or erased, or
+ * when the media may have changed, so the GPT is read again when next needed.
+ * Writes which lie entirely between the first and last usable LBAs of the
+ * cached GPT leave it in place.
+ *
+ * @desc: Block device descriptor
+ * @start: First block written
+ * @blkcnt: Number of blocks written, or 0 to drop everything cached for @desc
+ */
+void gpt_cache_invalidate(struct blk_desc *desc, lbaint_t start,
+			  lbaint_t blkcnt);
+
+#else
+static inline void gpt_cache_invalidate(struct blk_desc *desc, lbaint_t start,
+					lbaint_t blkcnt) {}
 #endif
 
 #if CONFIG_IS_ENABLED(DOS_PARTITION)
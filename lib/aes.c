@@ -102,408 +102,163 @@ static const u8 inv_sbox[256] = {
 	0xe1, 0x69, 0x14, 0x63, 0x55, 0x21, 0x0c, 0x7d
 };
 
-/* combined Xtimes2[Sbox[]] */
-static const u8 x2_sbox[256] = {
-	0xc6, 0xf8, 0xee, 0xf6, 0xff, 0xd6, 0xde, 0x91,
-	0x60, 0x02, 0xce, 0x56, 0xe7, 0xb5, 0x4d, 0xec,
-	0x8f, 0x1f, 0x89, 0xfa, 0xef, 0xb2, 0x8e, 0xfb,
-	0x41, 0xb3, 0x5f, 0x45, 0x23, 0x53, 0xe4, 0x9b,
-	0x75, 0xe1, 0x3d, 0x4c, 0x6c, 0x7e, 0xf5, 0x83,
-	0x68, 0x51, 0xd1, 0xf9, 0xe2, 0xab, 0x62, 0x2a,
-	0x08, 0x95, 0x46, 0x9d, 0x30, 0x37, 0x0a, 0x2f,
-	0x0e, 0x24, 0x1b, 0xdf, 0xcd, 0x4e, 0x7f, 0xea,
-	0x12, 0x1d, 0x58, 0x34, 0x36, 0xdc, 0xb4, 0x5b,
-	0xa4, 0x76, 0xb7, 0x7d, 0x52, 0xdd, 0x5e, 0x13,
-	0xa6, 0xb9, 0x00, 0xc1, 0x40, 0xe3, 0x79, 0xb6,
-	0xd4, 0x8d, 0x67, 0x72, 0x94, 0x98, 0xb0, 0x85,
-	0xbb, 0xc5, 0x4f, 0xed, 0x86, 0x9a, 0x66, 0x11,
-	0x8a, 0xe9, 0x04, 0xfe, 0xa0, 0x78, 0x25, 0x4b,
-	0xa2, 0x5d, 0x80, 0x05, 0x3f, 0x21, 0x70, 0xf1,
-	0x63, 0x77, 0xaf, 0x42, 0x20, 0xe5, 0xfd, 0xbf,
-	0x81, 0x18, 0x26, 0xc3, 0xbe, 0x35, 0x88, 0x2e,
-	0x93, 0x55, 0xfc, 0x7a, 0xc8, 0xba, 0x32, 0xe6,
-	0xc0, 0x19, 0x9e, 0xa3, 0x44, 0x54, 0x3b, 0x0b,
-	0x8c, 0xc7, 0x6b, 0x28, 0xa7, 0xbc, 0x16, 0xad,
-	0xdb, 0x64, 0x74, 0x14, 0x92, 0x0c, 0x48, 0xb8,
-	0x9f, 0xbd, 0x43, 0xc4, 0x39, 0x31, 0xd3, 0xf2,
-	0xd5, 0x8b, 0x6e, 0xda, 0x01, 0xb1, 0x9c, 0x49,
-	0xd8, 0xac, 0xf3, 0xcf, 0xca, 0xf4, 0x47, 0x10,
-	0x6f, 0xf0, 0x4a, 0x5c, 0x38, 0x57, 0x73, 0x97,
-	0xcb, 0xa1, 0xe8, 0x3e, 0x96, 0x61, 0x0d, 0x0f,
-	0xe0, 0x7c, 0x71, 0xcc, 0x90, 0x06, 0xf7, 0x1c,
-	0xc2, 0x6a, 0xae, 0x69, 0x17, 0x99, 0x3a, 0x27,
-	0xd9, 0xeb, 0x2b, 0x22, 0xd2, 0xa9, 0x07, 0x33,
-	0x2d, 0x3c, 0x15, 0xc9, 0x87, 0xaa, 0x50, 0xa5,
-	0x03, 0x59, 0x09, 0x1a, 0x65, 0xd7, 0x84, 0xd0,
-	0x82, 0x29, 0x5a, 0x1e, 0x7b, 0xa8, 0x6d, 0x2c
-};
-
-/* combined Xtimes3[Sbox[]] */
-static const u8 x3_sbox[256] = {
-	0xa5, 0x84, 0x99, 0x8d, 0x0d, 0xbd, 0xb1, 0x54,
-	0x50, 0x03, 0xa9, 0x7d, 0x19, 0x62, 0xe6, 0x9a,
-	0x45, 0x9d, 0x40, 0x87, 0x15, 0xeb, 0xc9, 0x0b,
-	0xec, 0x67, 0xfd, 0xea, 0xbf, 0xf7, 0x96, 0x5b,
-	0xc2, 0x1c, 0xae, 0x6a, 0x5a, 0x41, 0x02, 0x4f,
-	0x5c, 0xf4, 0x34, 0x08, 0x93, 0x73, 0x53, 0x3f,
-	0x0c, 0x52, 0x65, 0x5e, 0x28, 0xa1, 0x0f, 0xb5,
-	0x09, 0x36, 0x9b, 0x3d, 0x26, 0x69, 0xcd, 0x9f,
-	0x1b, 0x9e, 0x74, 0x2e, 0x2d, 0xb2, 0xee, 0xfb,
-	0xf6, 0x4d, 0x61, 0xce, 0x7b, 0x3e, 0x71, 0x97,
-	0xf5, 0x68, 0x00, 0x2c, 0x60, 0x1f, 0xc8, 0xed,
-	0xbe, 0x46, 0xd9, 0x4b, 0xde, 0xd4, 0xe8, 0x4a,
-	0x6b, 0x2a, 0xe5, 0x16, 0xc5, 0xd7, 0x55, 0x94,
-	0xcf, 0x10, 0x06, 0x81, 0xf0, 0x44, 0xba, 0xe3,
-	0xf3, 0xfe, 0xc0, 0x8a, 0xad, 0xbc, 0x48, 0x04,
-	0xdf, 0xc1, 0x75, 0x63, 0x30, 0x1a, 0x0e, 0x6d,
-	0x4c, 0x14, 0x35, 0x2f, 0xe1, 0xa2, 0xcc, 0x39,
-	0x57, 0xf2, 0x82, 0x47, 0xac, 0xe7, 0x2b, 0x95,
-	0xa0, 0x98, 0xd1, 0x7f, 0x66, 0x7e, 0xab, 0x83,
-	0xca, 0x29, 0xd3, 0x3c, 0x79, 0xe2, 0x1d, 0x76,
-	0x3b, 0x56, 0x4e, 0x1e, 0xdb, 0x0a, 0x6c, 0xe4,
-	0x5d, 0x6e, 0xef, 0xa6, 0xa8, 0xa4, 0x37, 0x8b,
-	0x32, 0x43, 0x59, 0xb7, 0x8c, 0x64, 0xd2, 0xe0,
-	0xb4, 0xfa, 0x07, 0x25, 0xaf, 0x8e, 0xe9, 0x18,
-	0xd5, 0x88, 0x6f, 0x72, 0x24, 0xf1, 0xc7, 0x51,
-	0x23, 0x7c, 0x9c, 0x21, 0xdd, 0xdc, 0x86, 0x85,
-	0x90, 0x42, 0xc4, 0xaa, 0xd8, 0x05, 0x01, 0x12,
-	0xa3, 0x5f, 0xf9, 0xd0, 0x91, 0x58, 0x27, 0xb9,
-	0x38, 0x13, 0xb3, 0x33, 0xbb, 0x70, 0x89, 0xa7,
-	0xb6, 0x22, 0x92, 0x20, 0x49, 0xff, 0x78, 0x7a,
-	0x8f, 0xf8, 0x80, 0x17, 0xda, 0x31, 0xc6, 0xb8,
-	0xc3, 0xb0, 0x77, 0x11, 0xcb, 0xfc, 0xd6, 0x3a
-};
-
 /*
- * modular multiplication tables based on:
- *
- * Xtime2[x] = (x & 0x80 ? 0x1b : 0) ^ (x + x)
- * Xtime3[x] = x^Xtime2[x];
+ * Round tables. te[x] is the column that MixColumns produces from byte x in
+ * row 0 after SubBytes, packed little-endian: (2.s, s, s, 3.s) with
+ * s = sbox[x]. Bytes in rows 1 to 3 use the same entry rotated left by 8, 16
+ * and 24 bits. td[] is the same for the inverse cipher, with columns
+ * (e.s, 9.s, d.s, b.s) and s = inv_sbox[x].
  */
-static const u8 x_time_9[256] = {
-	0x00, 0x09, 0x12, 0x1b, 0x24, 0x2d, 0x36, 0x3f,
-	0x48, 0x41, 0x5a, 0x53, 0x6c, 0x65, 0x7e, 0x77,
-	0x90, 0x99, 0x82, 0x8b, 0xb4, 0xbd, 0xa6, 0xaf,
-	0xd8, 0xd1, 0xca, 0xc3, 0xfc, 0xf5, 0xee, 0xe7,
-	0x3b, 0x32, 0x29, 0x20, 0x1f, 0x16, 0x0d, 0x04,
-	0x73, 0x7a, 0x61, 0x68, 0x57, 0x5e, 0x45, 0x4c,
-	0xab, 0xa2, 0xb9, 0xb0, 0x8f, 0x86, 0x9d, 0x94,
-	0xe3, 0xea, 0xf1, 0xf8, 0xc7, 0xce, 0xd5, 0xdc,
-	0x76, 0x7f, 0x64, 0x6d, 0x52, 0x5b, 0x40, 0x49,
-	0x3e, 0x37, 0x2c, 0x25, 0x1a, 0x13, 0x08, 0x01,
-	0xe6, 0xef, 0xf4, 0xfd, 0xc2, 0xcb, 0xd0, 0xd9,
-	0xae, 0xa7, 0xbc, 0xb5, 0x8a, 0x83, 0x98, 0x91,
-	0x4d, 0x44, 0x5f, 0x56, 0x69, 0x60, 0x7b, 0x72,
-	0x05, 0x0c, 0x17, 0x1e, 0x21, 0x28, 0x33, 0x3a,
-	0xdd, 0xd4, 0xcf, 0xc6, 0xf9, 0xf0, 0xeb, 0xe2,
-	0x95, 0x9c, 0x87, 0x8e, 0xb1, 0xb8, 0xa3, 0xaa,
-	0xec, 0xe5, 0xfe, 0xf7, 0xc8, 0xc1, 0xda, 0xd3,
-	0xa4, 0xad, 0xb6, 0xbf, 0x80, 0x89, 0x92, 0x9b,
-	0x7c, 0x75, 0x6e, 0x67, 0x58, 0x51, 0x4a, 0x43,
-	0x34, 0x3d, 0x26, 0x2f, 0x10, 0x19, 0x02, 0x0b,
-	0xd7, 0xde, 0xc5, 0xcc, 0xf3, 0xfa, 0xe1, 0xe8,
-	0x9f, 0x96, 0x8d, 0x84, 0xbb, 0xb2, 0xa9, 0xa0,
-	0x47, 0x4e, 0x55, 0x5c, 0x63, 0x6a, 0x71, 0x78,
-	0x0f, 0x06, 0x1d, 0x14, 0x2b, 0x22, 0x39, 0x30,
-	0x9a, 0x93, 0x88, 0x81, 0xbe, 0xb7, 0xac, 0xa5,
-	0xd2, 0xdb, 0xc0, 0xc9, 0xf6, 0xff, 0xe4, 0xed,
-	0x0a, 0x03, 0x18, 0x11, 0x2e, 0x27, 0x3c, 0x35,
-	0x42, 0x4b, 0x50, 0x59, 0x66, 0x6f, 0x74, 0x7d,
-	0xa1, 0xa8, 0xb3, 0xba, 0x85, 0x8c, 0x97, 0x9e,
-	0xe9, 0xe0, 0xfb, 0xf2, 0xcd, 0xc4, 0xdf, 0xd6,
-	0x31, 0x38, 0x23, 0x2a, 0x15, 0x1c, 0x07, 0x0e,
-	0x79, 0x70, 0x6b, 0x62, 0x5d, 0x54, 0x4f, 0x46
-};
-
-static const u8 x_time_b[256] = {
-	0x00, 0x0b, 0x16, 0x1d, 0x2c, 0x27, 0x3a, 0x31,
-	0x58, 0x53, 0x4e, 0x45, 0x74, 0x7f, 0x62, 0x69,
-	0xb0, 0xbb, 0xa6, 0xad, 0x9c, 0x97, 0x8a, 0x81,
-	0xe8, 0xe3, 0xfe, 0xf5, 0xc4, 0xcf, 0xd2, 0xd9,
-	0x7b, 0x70, 0x6d, 0x66, 0x57, 0x5c, 0x41, 0x4a,
-	0x23, 0x28, 0x35, 0x3e, 0x0f, 0x04, 0x19, 0x12,
-	0xcb, 0xc0, 0xdd, 0xd6, 0xe7, 0xec, 0xf1, 0xfa,
-	0x93, 0x98, 0x85, 0x8e, 0xbf, 0xb4, 0xa9, 0xa2,
-	0xf6, 0xfd, 0xe0, 0xeb, 0xda, 0xd1, 0xcc, 0xc7,
-	0xae, 0xa5, 0xb8, 0xb3, 0x82, 0x89, 0x94, 0x9f,
-	0x46, 0x4d, 0x50, 0x5b, 0x6a, 0x61, 0x7c, 0x77,
-	0x1e, 0x15, 0x08, 0x03, 0x32, 0x39, 0x24, 0x2f,
-	0x8d, 0x86, 0x9b, 0x90, 0xa1, 0xaa, 0xb7, 0xbc,
-	0xd5, 0xde, 0xc3, 0xc8, 0xf9, 0xf2, 0xef, 0xe4,
-	0x3d, 0x36, 0x2b, 0x20, 0x11, 0x1a, 0x07, 0x0c,
-	0x65, 0x6e, 0x73, 0x78, 0x49, 0x42, 0x5f, 0x54,
-	0xf7, 0xfc, 0xe1, 0xea, 0xdb, 0xd0, 0xcd, 0xc6,
-	0xaf, 0xa4, 0xb9, 0xb2, 0x83, 0x88, 0x95, 0x9e,
-	0x47, 0x4c, 0x51, 0x5a, 0x6b, 0x60, 0x7d, 0x76,
-	0x1f, 0x14, 0x09, 0x02, 0x33, 0x38, 0x25, 0x2e,
-	0x8c, 0x87, 0x9a, 0x91, 0xa0, 0xab, 0xb6, 0xbd,
-	0xd4, 0xdf, 0xc2, 0xc9, 0xf8, 0xf3, 0xee, 0xe5,
-	0x3c, 0x37, 0x2a, 0x21, 0x10, 0x1b, 0x06, 0x0d,
-	0x64, 0x6f, 0x72, 0x79, 0x48, 0x43, 0x5e, 0x55,
-	0x01, 0x0a, 0x17, 0x1c, 0x2d, 0x26, 0x3b, 0x30,
-	0x59, 0x52, 0x4f, 0x44, 0x75, 0x7e, 0x63, 0x68,
-	0xb1, 0xba, 0xa7, 0xac, 0x9d, 0x96, 0x8b, 0x80,
-	0xe9, 0xe2, 0xff, 0xf4, 0xc5, 0xce, 0xd3, 0xd8,
-	0x7a, 0x71, 0x6c, 0x67, 0x56, 0x5d, 0x40, 0x4b,
-	0x22, 0x29, 0x34, 0x3f, 0x0e, 0x05, 0x18, 0x13,
-	0xca, 0xc1, 0xdc, 0xd7, 0xe6, 0xed, 0xf0, 0xfb,
-	0x92, 0x99, 0x84, 0x8f, 0xbe, 0xb5, 0xa8, 0xa3
-};
-
-static const u8 x_time_d[256] = {
-	0x00, 0x0d, 0x1a, 0x17, 0x34, 0x39, 0x2e, 0x23,
-	0x68, 0x65, 0x72, 0x7f, 0x5c, 0x51, 0x46, 0x4b,
-	0xd0, 0xdd, 0xca, 0xc7, 0xe4, 0xe9, 0xfe, 0xf3,
-	0xb8, 0xb5, 0xa2, 0xaf, 0x8c, 0x81, 0x96, 0x9b,
-	0xbb, 0xb6, 0xa1, 0xac, 0x8f, 0x82, 0x95, 0x98,
-	0xd3, 0xde, 0xc9, 0xc4, 0xe7, 0xea, 0xfd, 0xf0,
-	0x6b, 0x66, 0x71, 0x7c, 0x5f, 0x52, 0x45, 0x48,
-	0x03, 0x0e, 0x19, 0x14, 0x37, 0x3a, 0x2d, 0x20,
-	0x6d, 0x60, 0x77, 0x7a, 0x59, 0x54, 0x43, 0x4e,
-	0x05, 0x08, 0x1f, 0x12, 0x31, 0x3c, 0x2b, 0x26,
-	0xbd, 0xb0, 0xa7, 0xaa, 0x89, 0x84, 0x93, 0x9e,
-	0xd5, 0xd8, 0xcf, 0xc2, 0xe1, 0xec, 0xfb, 0xf6,
-	0xd6, 0xdb, 0xcc, 0xc1, 0xe2, 0xef, 0xf8, 0xf5,
-	0xbe, 0xb3, 0xa4, 0xa9, 0x8a, 0x87, 0x90, 0x9d,
-	0x06, 0x0b, 0x1c, 0x11, 0x32, 0x3f, 0x28, 0x25,
-	0x6e, 0x63, 0x74, 0x79, 0x5a, 0x57, 0x40, 0x4d,
-	0xda, 0xd7, 0xc0, 0xcd, 0xee, 0xe3, 0xf4, 0xf9,
-	0xb2, 0xbf, 0xa8, 0xa5, 0x86, 0x8b, 0x9c, 0x91,
-	0x0a, 0x07, 0x10, 0x1d, 0x3e, 0x33, 0x24, 0x29,
-	0x62, 0x6f, 0x78, 0x75, 0x56, 0x5b, 0x4c, 0x41,
-	0x61, 0x6c, 0x7b, 0x76, 0x55, 0x58, 0x4f, 0x42,
-	0x09, 0x04, 0x13, 0x1e, 0x3d, 0x30, 0x27, 0x2a,
-	0xb1, 0xbc, 0xab, 0xa6, 0x85, 0x88, 0x9f, 0x92,
-	0xd9, 0xd4, 0xc3, 0xce, 0xed, 0xe0, 0xf7, 0xfa,
-	0xb7, 0xba, 0xad, 0xa0, 0x83, 0x8e, 0x99, 0x94,
-	0xdf, 0xd2, 0xc5, 0xc8, 0xeb, 0xe6, 0xf1, 0xfc,
-	0x67, 0x6a, 0x7d, 0x70, 0x53, 0x5e, 0x49, 0x44,
-	0x0f, 0x02, 0x15, 0x18, 0x3b, 0x36, 0x21, 0x2c,
-	0x0c, 0x01, 0x16, 0x1b, 0x38, 0x35, 0x22, 0x2f,
-	0x64, 0x69, 0x7e, 0x73, 0x50, 0x5d, 0x4a, 0x47,
-	0xdc, 0xd1, 0xc6, 0xcb, 0xe8, 0xe5, 0xf2, 0xff,
-	0xb4, 0xb9, 0xae, 0xa3, 0x80, 0x8d, 0x9a, 0x97
+static const u32 te[256] = {
+	0xa56363c6, 0x847c7cf8, 0x997777ee, 0x8d7b7bf6,
+	0x0df2f2ff, 0xbd6b6bd6, 0xb16f6fde, 0x54c5c591,
+	0x50303060, 0x03010102, 0xa96767ce, 0x7d2b2b56,
+	0x19fefee7, 0x62d7d7b5, 0xe6abab4d, 0x9a7676ec,
+	0x45caca8f, 0x9d82821f, 0x40c9c989, 0x877d7dfa,
+	0x15fafaef, 0xeb5959b2, 0xc947478e, 0x0bf0f0fb,
+	0xecadad41, 0x67d4d4b3, 0xfda2a25f, 0xeaafaf45,
+	0xbf9c9c23, 0xf7a4a453, 0x967272e4, 0x5bc0c09b,
+	0xc2b7b775, 0x1cfdfde1, 0xae93933d, 0x6a26264c,
+	0x5a36366c, 0x413f3f7e, 0x02f7f7f5, 0x4fcccc83,
+	0x5c343468, 0xf4a5a551, 0x34e5e5d1, 0x08f1f1f9,
+	0x937171e2, 0x73d8d8ab, 0x53313162, 0x3f15152a,
+	0x0c040408, 0x52c7c795, 0x65232346, 0x5ec3c39d,
+	0x28181830, 0xa1969637, 0x0f05050a, 0xb59a9a2f,
+	0x0907070e, 0x36121224, 0x9b80801b, 0x3de2e2df,
+	0x26ebebcd, 0x6927274e, 0xcdb2b27f, 0x9f7575ea,
+	0x1b090912, 0x9e83831d, 0x742c2c58, 0x2e1a1a34,
+	0x2d1b1b36, 0xb26e6edc, 0xee5a5ab4, 0xfba0a05b,
+	0xf65252a4, 0x4d3b3b76, 0x61d6d6b7, 0xceb3b37d,
+	0x7b292952, 0x3ee3e3dd, 0x712f2f5e, 0x97848413,
+	0xf55353a6, 0x68d1d1b9, 0x00000000, 0x2cededc1,
+	0x60202040, 0x1ffcfce3, 0xc8b1b179, 0xed5b5bb6,
+	0xbe6a6ad4, 0x46cbcb8d, 0xd9bebe67, 0x4b393972,
+	0xde4a4a94, 0xd44c4c98, 0xe85858b0, 0x4acfcf85,
+	0x6bd0d0bb, 0x2aefefc5, 0xe5aaaa4f, 0x16fbfbed,
+	0xc5434386, 0xd74d4d9a, 0x55333366, 0x94858511,
+	0xcf45458a, 0x10f9f9e9, 0x06020204, 0x817f7ffe,
+	0xf05050a0, 0x443c3c78, 0xba9f9f25, 0xe3a8a84b,
+	0xf35151a2, 0xfea3a35d, 0xc0404080, 0x8a8f8f05,
+	0xad92923f, 0xbc9d9d21, 0x48383870, 0x04f5f5f1,
+	0xdfbcbc63, 0xc1b6b677, 0x75dadaaf, 0x63212142,
+	0x30101020, 0x1affffe5, 0x0ef3f3fd, 0x6dd2d2bf,
+	0x4ccdcd81, 0x140c0c18, 0x35131326, 0x2fececc3,
+	0xe15f5fbe, 0xa2979735, 0xcc444488, 0x3917172e,
+	0x57c4c493, 0xf2a7a755, 0x827e7efc, 0x473d3d7a,
+	0xac6464c8, 0xe75d5dba, 0x2b191932, 0x957373e6,
+	0xa06060c0, 0x98818119, 0xd14f4f9e, 0x7fdcdca3,
+	0x66222244, 0x7e2a2a54, 0xab90903b, 0x8388880b,
+	0xca46468c, 0x29eeeec7, 0xd3b8b86b, 0x3c141428,
+	0x79dedea7, 0xe25e5ebc, 0x1d0b0b16, 0x76dbdbad,
+	0x3be0e0db, 0x56323264, 0x4e3a3a74, 0x1e0a0a14,
+	0xdb494992, 0x0a06060c, 0x6c242448, 0xe45c5cb8,
+	0x5dc2c29f, 0x6ed3d3bd, 0xefacac43, 0xa66262c4,
+	0xa8919139, 0xa4959531, 0x37e4e4d3, 0x8b7979f2,
+	0x32e7e7d5, 0x43c8c88b, 0x5937376e, 0xb76d6dda,
+	0x8c8d8d01, 0x64d5d5b1, 0xd24e4e9c, 0xe0a9a949,
+	0xb46c6cd8, 0xfa5656ac, 0x07f4f4f3, 0x25eaeacf,
+	0xaf6565ca, 0x8e7a7af4, 0xe9aeae47, 0x18080810,
+	0xd5baba6f, 0x887878f0, 0x6f25254a, 0x722e2e5c,
+	0x241c1c38, 0xf1a6a657, 0xc7b4b473, 0x51c6c697,
+	0x23e8e8cb, 0x7cdddda1, 0x9c7474e8, 0x211f1f3e,
+	0xdd4b4b96, 0xdcbdbd61, 0x868b8b0d, 0x858a8a0f,
+	0x907070e0, 0x423e3e7c, 0xc4b5b571, 0xaa6666cc,
+	0xd8484890, 0x05030306, 0x01f6f6f7, 0x120e0e1c,
+	0xa36161c2, 0x5f35356a, 0xf95757ae, 0xd0b9b969,
+	0x91868617, 0x58c1c199, 0x271d1d3a, 0xb99e9e27,
+	0x38e1e1d9, 0x13f8f8eb, 0xb398982b, 0x33111122,
+	0xbb6969d2, 0x70d9d9a9, 0x898e8e07, 0xa7949433,
+	0xb69b9b2d, 0x221e1e3c, 0x92878715, 0x20e9e9c9,
+	0x49cece87, 0xff5555aa, 0x78282850, 0x7adfdfa5,
+	0x8f8c8c03, 0xf8a1a159, 0x80898909, 0x170d0d1a,
+	0xdabfbf65, 0x31e6e6d7, 0xc6424284, 0xb86868d0,
+	0xc3414182, 0xb0999929, 0x772d2d5a, 0x110f0f1e,
+	0xcbb0b07b, 0xfc5454a8, 0xd6bbbb6d, 0x3a16162c
 };
 
-static const u8 x_time_e[256] = {
-	0x00, 0x0e, 0x1c, 0x12, 0x38, 0x36, 0x24, 0x2a,
-	0x70, 0x7e, 0x6c, 0x62, 0x48, 0x46, 0x54, 0x5a,
-	0xe0, 0xee, 0xfc, 0xf2, 0xd8, 0xd6, 0xc4, 0xca,
-	0x90, 0x9e, 0x8c, 0x82, 0xa8, 0xa6, 0xb4, 0xba,
-	0xdb, 0xd5, 0xc7, 0xc9, 0xe3, 0xed, 0xff, 0xf1,
-	0xab, 0xa5, 0xb7, 0xb9, 0x93, 0x9d, 0x8f, 0x81,
-	0x3b, 0x35, 0x27, 0x29, 0x03, 0x0d, 0x1f, 0x11,
-	0x4b, 0x45, 0x57, 0x59, 0x73, 0x7d, 0x6f, 0x61,
-	0xad, 0xa3, 0xb1, 0xbf, 0x95, 0x9b, 0x89, 0x87,
-	0xdd, 0xd3, 0xc1, 0xcf, 0xe5, 0xeb, 0xf9, 0xf7,
-	0x4d, 0x43, 0x51, 0x5f, 0x75, 0x7b, 0x69, 0x67,
-	0x3d, 0x33, 0x21, 0x2f, 0x05, 0x0b, 0x19, 0x17,
-	0x76, 0x78, 0x6a, 0x64, 0x4e, 0x40, 0x52, 0x5c,
-	0x06, 0x08, 0x1a, 0x14, 0x3e, 0x30, 0x22, 0x2c,
-	0x96, 0x98, 0x8a, 0x84, 0xae, 0xa0, 0xb2, 0xbc,
-	0xe6, 0xe8, 0xfa, 0xf4, 0xde, 0xd0, 0xc2, 0xcc,
-	0x41, 0x4f, 0x5d, 0x53, 0x79, 0x77, 0x65, 0x6b,
-	0x31, 0x3f, 0x2d, 0x23, 0x09, 0x07, 0x15, 0x1b,
-	0xa1, 0xaf, 0xbd, 0xb3, 0x99, 0x97, 0x85, 0x8b,
-	0xd1, 0xdf, 0xcd, 0xc3, 0xe9, 0xe7, 0xf5, 0xfb,
-	0x9a, 0x94, 0x86, 0x88, 0xa2, 0xac, 0xbe, 0xb0,
-	0xea, 0xe4, 0xf6, 0xf8, 0xd2, 0xdc, 0xce, 0xc0,
-	0x7a, 0x74, 0x66, 0x68, 0x42, 0x4c, 0x5e, 0x50,
-	0x0a, 0x04, 0x16, 0x18, 0x32, 0x3c, 0x2e, 0x20,
-	0xec, 0xe2, 0xf0, 0xfe, 0xd4, 0xda, 0xc8, 0xc6,
-	0x9c, 0x92, 0x80, 0x8e, 0xa4, 0xaa, 0xb8, 0xb6,
-	0x0c, 0x02, 0x10, 0x1e, 0x34, 0x3a, 0x28, 0x26,
-	0x7c, 0x72, 0x60, 0x6e, 0x44, 0x4a, 0x58, 0x56,
-	0x37, 0x39, 0x2b, 0x25, 0x0f, 0x01, 0x13, 0x1d,
-	0x47, 0x49, 0x5b, 0x55, 0x7f, 0x71, 0x63, 0x6d,
-	0xd7, 0xd9, 0xcb, 0xc5, 0xef, 0xe1, 0xf3, 0xfd,
-	0xa7, 0xa9, 0xbb, 0xb5, 0x9f, 0x91, 0x83, 0x8d
+static const u32 td[256] = {
+	0x50a7f451, 0x5365417e, 0xc3a4171a, 0x965e273a,
+	0xcb6bab3b, 0xf1459d1f, 0xab58faac, 0x9303e34b,
+	0x55fa3020, 0xf66d76ad, 0x9176cc88, 0x254c02f5,
+	0xfcd7e54f, 0xd7cb2ac5, 0x80443526, 0x8fa362b5,
+	0x495ab1de, 0x671bba25, 0x980eea45, 0xe1c0fe5d,
+	0x02752fc3, 0x12f04c81, 0xa397468d, 0xc6f9d36b,
+	0xe75f8f03, 0x959c9215, 0xeb7a6dbf, 0xda595295,
+	0x2d83bed4, 0xd3217458, 0x2969e049, 0x44c8c98e,
+	0x6a89c275, 0x78798ef4, 0x6b3e5899, 0xdd71b927,
+	0xb64fe1be, 0x17ad88f0, 0x66ac20c9, 0xb43ace7d,
+	0x184adf63, 0x82311ae5, 0x60335197, 0x457f5362,
+	0xe07764b1, 0x84ae6bbb, 0x1ca081fe, 0x942b08f9,
+	0x58684870, 0x19fd458f, 0x876cde94, 0xb7f87b52,
+	0x23d373ab, 0xe2024b72, 0x578f1fe3, 0x2aab5566,
+	0x0728ebb2, 0x03c2b52f, 0x9a7bc586, 0xa50837d3,
+	0xf2872830, 0xb2a5bf23, 0xba6a0302, 0x5c8216ed,
+	0x2b1ccf8a, 0x92b479a7, 0xf0f207f3, 0xa1e2694e,
+	0xcdf4da65, 0xd5be0506, 0x1f6234d1, 0x8afea6c4,
+	0x9d532e34, 0xa055f3a2, 0x32e18a05, 0x75ebf6a4,
+	0x39ec830b, 0xaaef6040, 0x069f715e, 0x51106ebd,
+	0xf98a213e, 0x3d06dd96, 0xae053edd, 0x46bde64d,
+	0xb58d5491, 0x055dc471, 0x6fd40604, 0xff155060,
+	0x24fb9819, 0x97e9bdd6, 0xcc434089, 0x779ed967,
+	0xbd42e8b0, 0x888b8907, 0x385b19e7, 0xdbeec879,
+	0x470a7ca1, 0xe90f427c, 0xc91e84f8, 0x00000000,
+	0x83868009, 0x48ed2b32, 0xac70111e, 0x4e725a6c,
+	0xfbff0efd, 0x5638850f, 0x1ed5ae3d, 0x27392d36,
+	0x64d90f0a, 0x21a65c68, 0xd1545b9b, 0x3a2e3624,
+	0xb1670a0c, 0x0fe75793, 0xd296eeb4, 0x9e919b1b,
+	0x4fc5c080, 0xa220dc61, 0x694b775a, 0x161a121c,
+	0x0aba93e2, 0xe52aa0c0, 0x43e0223c, 0x1d171b12,
+	0x0b0d090e, 0xadc78bf2, 0xb9a8b62d, 0xc8a91e14,
+	0x8519f157, 0x4c0775af, 0xbbdd99ee, 0xfd607fa3,
+	0x9f2601f7, 0xbcf5725c, 0xc53b6644, 0x347efb5b,
+	0x7629438b, 0xdcc623cb, 0x68fcedb6, 0x63f1e4b8,
+	0xcadc31d7, 0x10856342, 0x40229713, 0x2011c684,
+	0x7d244a85, 0xf83dbbd2, 0x1132f9ae, 0x6da129c7,
+	0x4b2f9e1d, 0xf330b2dc, 0xec52860d, 0xd0e3c177,
+	0x6c16b32b, 0x99b970a9, 0xfa489411, 0x2264e947,
+	0xc48cfca8, 0x1a3ff0a0, 0xd82c7d56, 0xef903322,
+	0xc74e4987, 0xc1d138d9, 0xfea2ca8c, 0x360bd498,
+	0xcf81f5a6, 0x28de7aa5, 0x268eb7da, 0xa4bfad3f,
+	0xe49d3a2c, 0x0d927850, 0x9bcc5f6a, 0x62467e54,
+	0xc2138df6, 0xe8b8d890, 0x5ef7392e, 0xf5afc382,
+	0xbe805d9f, 0x7c93d069, 0xa92dd56f, 0xb31225cf,
+	0x3b99acc8, 0xa77d1810, 0x6e639ce8, 0x7bbb3bdb,
+	0x097826cd, 0xf418596e, 0x01b79aec, 0xa89a4f83,
+	0x656e95e6, 0x7ee6ffaa, 0x08cfbc21, 0xe6e815ef,
+	0xd99be7ba, 0xce366f4a, 0xd4099fea, 0xd67cb029,
+	0xafb2a431, 0x31233f2a, 0x3094a5c6, 0xc066a235,
+	0x37bc4e74, 0xa6ca82fc, 0xb0d090e0, 0x15d8a733,
+	0x4a9804f1, 0xf7daec41, 0x0e50cd7f, 0x2ff69117,
+	0x8dd64d76, 0x4db0ef43, 0x544daacc, 0xdf0496e4,
+	0xe3b5d19e, 0x1b886a4c, 0xb81f2cc1, 0x7f516546,
+	0x04ea5e9d, 0x5d358c01, 0x737487fa, 0x2e410bfb,
+	0x5a1d67b3, 0x52d2db92, 0x335610e9, 0x1347d66d,
+	0x8c61d79a, 0x7a0ca137, 0x8e14f859, 0x893c13eb,
+	0xee27a9ce, 0x35c961b7, 0xede51ce1, 0x3cb1477a,
+	0x59dfd29c, 0x3f73f255, 0x79ce1418, 0xbf37c773,
+	0xeacdf753, 0x5baafd5f, 0x146f3ddf, 0x86db4478,
+	0x81f3afca, 0x3ec468b9, 0x2c342438, 0x5f40a3c2,
+	0x72c31d16, 0x0c25e2bc, 0x8b493c28, 0x41950dff,
+	0x7101a839, 0xdeb30c08, 0x9ce4b4d8, 0x90c15664,
+	0x6184cb7b, 0x70b632d5, 0x745c6c48, 0x4257b8d0
 };
 
-/*
- * Exchanges columns in each of 4 rows
- * row0 - unchanged, row1- shifted left 1,
- * row2 - shifted left 2 and row3 - shifted left 3
- */
-static void shift_rows(u8 *state)
-{
-	u8 tmp;
-
-	/* just substitute row 0 */
-	state[0] = sbox[state[0]];
-	state[4] = sbox[state[4]];
-	state[8] = sbox[state[8]];
-	state[12] = sbox[state[12]];
-
-	/* rotate row 1 */
-	tmp = sbox[state[1]];
-	state[1] = sbox[state[5]];
-	state[5] = sbox[state[9]];
-	state[9] = sbox[state[13]];
-	state[13] = tmp;
-
-	/* rotate row 2 */
-	tmp = sbox[state[2]];
-	state[2] = sbox[state[10]];
-	state[10] = tmp;
-	tmp = sbox[state[6]];
-	state[6] = sbox[state[14]];
-	state[14] = tmp;
-
-	/* rotate row 3 */
-	tmp = sbox[state[15]];
-	state[15] = sbox[state[11]];
-	state[11] = sbox[state[7]];
-	state[7] = sbox[state[3]];
-	state[3] = tmp;
-}
-
-/*
- * restores columns in each of 4 rows
- * row0 - unchanged, row1- shifted right 1,
- * row2 - shifted right 2 and row3 - shifted right 3
- */
-static void inv_shift_rows(u8 *state)
-{
-	u8 tmp;
-
-	/* restore row 0 */
-	state[0] = inv_sbox[state[0]];
-	state[4] = inv_sbox[state[4]];
-	state[8] = inv_sbox[state[8]];
-	state[12] = inv_sbox[state[12]];
-
-	/* restore row 1 */
-	tmp = inv_sbox[state[13]];
-	state[13] = inv_sbox[state[9]];
-	state[9] = inv_sbox[state[5]];
-	state[5] = inv_sbox[state[1]];
-	state[1] = tmp;
-
-	/* restore row 2 */
-	tmp = inv_sbox[state[2]];
-	state[2] = inv_sbox[state[10]];
-	state[10] = tmp;
-	tmp = inv_sbox[state[6]];
-	state[6] = inv_sbox[state[14]];
-	state[14] = tmp;
-
-	/* restore row 3 */
-	tmp = inv_sbox[state[3]];
-	state[3] = inv_sbox[state[7]];
-	state[7] = inv_sbox[state[11]];
-	state[11] = inv_sbox[state[15]];
-	state[15] = tmp;
-}
-
-/* recombine and mix each row in a column */
-static void mix_sub_columns(u8 *state)
+static inline u32 aes_rol(u32 val, int shift)
 {
-	u8 tmp[4 * AES_STATECOLS];
-
-	/* mixing column 0 */
-	tmp[0] = x2_sbox[state[0]] ^ x3_sbox[state[5]] ^
-		 sbox[state[10]] ^ sbox[state[15]];
-	tmp[1] = sbox[state[0]] ^ x2_sbox[state[5]] ^
-		 x3_sbox[state[10]] ^ sbox[state[15]];
-	tmp[2] = sbox[state[0]] ^ sbox[state[5]] ^
-		 x2_sbox[state[10]] ^ x3_sbox[state[15]];
-	tmp[3] = x3_sbox[state[0]] ^ sbox[state[5]] ^
-		 sbox[state[10]] ^ x2_sbox[state[15]];
-
-	/* mixing column 1 */
-	tmp[4] = x2_sbox[state[4]] ^ x3_sbox[state[9]] ^
-		 sbox[state[14]] ^ sbox[state[3]];
-	tmp[5] = sbox[state[4]] ^ x2_sbox[state[9]] ^
-		 x3_sbox[state[14]] ^ sbox[state[3]];
-	tmp[6] = sbox[state[4]] ^ sbox[state[9]] ^
-		 x2_sbox[state[14]] ^ x3_sbox[state[3]];
-	tmp[7] = x3_sbox[state[4]] ^ sbox[state[9]] ^
-		 sbox[state[14]] ^ x2_sbox[state[3]];
-
-	/* mixing column 2 */
-	tmp[8] = x2_sbox[state[8]] ^ x3_sbox[state[13]] ^
-		 sbox[state[2]] ^ sbox[state[7]];
-	tmp[9] = sbox[state[8]] ^ x2_sbox[state[13]] ^
-		 x3_sbox[state[2]] ^ sbox[state[7]];
-	tmp[10] = sbox[state[8]] ^ sbox[state[13]] ^
-		  x2_sbox[state[2]] ^ x3_sbox[state[7]];
-	tmp[11] = x3_sbox[state[8]] ^ sbox[state[13]] ^
-		  sbox[state[2]] ^ x2_sbox[state[7]];
-
-	/* mixing column 3 */
-	tmp[12] = x2_sbox[state[12]] ^ x3_sbox[state[1]] ^
-		  sbox[state[6]] ^ sbox[state[11]];
-	tmp[13] = sbox[state[12]] ^ x2_sbox[state[1]] ^
-		  x3_sbox[state[6]] ^ sbox[state[11]];
-	tmp[14] = sbox[state[12]] ^ sbox[state[1]] ^
-		  x2_sbox[state[6]] ^ x3_sbox[state[11]];
-	tmp[15] = x3_sbox[state[12]] ^ sbox[state[1]] ^
-		  sbox[state[6]] ^ x2_sbox[state[11]];
-
-	memcpy(state, tmp, sizeof(tmp));
+	return (val << shift) | (val >> (32 - shift));
 }
 
-/* restore and un-mix each row in a column */
-static void inv_mix_sub_columns(u8 *state)
+static inline u32 aes_get_le32(const u8 *p)
 {
-	u8 tmp[4 * AES_STATECOLS];
-	int  i;
-
-	/* restore column 0 */
-	tmp[0] = x_time_e[state[0]] ^ x_time_b[state[1]] ^
-		 x_time_d[state[2]] ^ x_time_9[state[3]];
-	tmp[5] = x_time_9[state[0]] ^ x_time_e[state[1]] ^
-		 x_time_b[state[2]] ^ x_time_d[state[3]];
-	tmp[10] = x_time_d[state[0]] ^ x_time_9[state[1]] ^
-		  x_time_e[state[2]] ^ x_time_b[state[3]];
-	tmp[15] = x_time_b[state[0]] ^ x_time_d[state[1]] ^
-		  x_time_9[state[2]] ^ x_time_e[state[3]];
-
-	/* restore column 1 */
-	tmp[4] = x_time_e[state[4]] ^ x_time_b[state[5]] ^
-		 x_time_d[state[6]] ^ x_time_9[state[7]];
-	tmp[9] = x_time_9[state[4]] ^ x_time_e[state[5]] ^
-		 x_time_b[state[6]] ^ x_time_d[state[7]];
-	tmp[14] = x_time_d[state[4]] ^ x_time_9[state[5]] ^
-		  x_time_e[state[6]] ^ x_time_b[state[7]];
-	tmp[3] = x_time_b[state[4]] ^ x_time_d[state[5]] ^
-		 x_time_9[state[6]] ^ x_time_e[state[7]];
-
-	/* restore column 2 */
-	tmp[8] = x_time_e[state[8]] ^ x_time_b[state[9]] ^
-		 x_time_d[state[10]] ^ x_time_9[state[11]];
-	tmp[13] = x_time_9[state[8]] ^ x_time_e[state[9]] ^
-		  x_time_b[state[10]] ^ x_time_d[state[11]];
-	tmp[2] = x_time_d[state[8]] ^ x_time_9[state[9]] ^
-		 x_time_e[state[10]] ^ x_time_b[state[11]];
-	tmp[7] = x_time_b[state[8]] ^ x_time_d[state[9]] ^
-		 x_time_9[state[10]] ^ x_time_e[state[11]];
-
-	/* restore column 3 */
-	tmp[12] = x_time_e[state[12]] ^ x_time_b[state[13]] ^
-		  x_time_d[state[14]] ^ x_time_9[state[15]];
-	tmp[1] = x_time_9[state[12]] ^ x_time_e[state[13]] ^
-		 x_time_b[state[14]] ^ x_time_d[state[15]];
-	tmp[6] = x_time_d[state[12]] ^ x_time_9[state[13]] ^
-		 x_time_e[state[14]] ^ x_time_b[state[15]];
-	tmp[11] = x_time_b[state[12]] ^ x_time_d[state[13]] ^
-		  x_time_9[state[14]] ^ x_time_e[state[15]];
-
-	for (i = 0; i < 4 * AES_STATECOLS; i++)
-		state[i] = inv_sbox[tmp[i]];
+	return p[0] | p[1] << 8 | p[2] << 16 | (u32)p[3] << 24;
 }
 
-/*
- * encrypt/decrypt columns of the key
- * n.b. you can replace this with byte-wise xor if you wish.
- */
-static void add_round_key(u32 *state, u32 *key)
+static inline void aes_put_le32(u8 *p, u32 val)
 {
-	int idx;
-
-	for (idx = 0; idx < 4; idx++)
-		state[idx] ^= key[idx];
+	p[0] = val;
+	p[1] = val >> 8;
+	p[2] = val >> 16;
+	p[3] = val >> 24;
 }
 
 static u8 rcon[11] = {
@@ -570,51 +325,139 @@ void aes_expand_key(u8 *key, u32 key_len, u8 *expkey)
 	}
 }
 
-/* encrypt one 128 bit block */
-void aes_encrypt(u32 key_len, u8 *in, u8 *expkey, u8 *out)
-{
-	u8 state[AES_STATECOLS * 4];
-	u32 round, aes_rounds;
+/* round keys for the largest key size, as 32-bit columns */
+#define AES_MAX_RK_WORDS	(AES256_EXPAND_KEY_LENGTH / 4)
 
-	aes_rounds = aes_get_rounds(key_len);
+/* load the expanded key as little-endian columns */
+static void aes_load_enc_key(u32 *rk, const u8 *expkey, u32 rounds)
+{
+	u32 i;
 
-	memcpy(state, in, AES_STATECOLS * 4);
-	add_round_key((u32 *)state, (u32 *)expkey);
+	for (i = 0; i < AES_STATECOLS * (rounds + 1); i++)
+		rk[i] = aes_get_le32(expkey + 4 * i);
+}
 
-	for (round = 1; round < aes_rounds + 1; round++) {
-		if (round < aes_rounds)
-			mix_sub_columns(state);
-		else
-			shift_rows(state);
+/*
+ * Build the key schedule of the equivalent inverse cipher (FIPS-197 5.3.5):
+ * round keys in reverse order, with InvMixColumns applied to all but the
+ * first and last. InvMixColumns of a byte x is td[sbox[x]].
+ */
+static void aes_load_dec_key(u32 *dk, const u8 *expkey, u32 rounds)
+{
+	u32 round, col, w;
+
+	for (round = 0; round <= rounds; round++) {
+		for (col = 0; col < AES_STATECOLS; col++) {
+			w = aes_get_le32(expkey + 16 * (rounds - round) +
+					 4 * col);
+			if (round && round < rounds)
+				w = td[sbox[w & 0xff]] ^
+				    aes_rol(td[sbox[(w >> 8) & 0xff]], 8) ^
+				    aes_rol(td[sbox[(w >> 16) & 0xff]], 16) ^
+				    aes_rol(td[sbox[w >> 24]], 24);
+			*dk++ = w;
+		}
+	}
+}
 
-		add_round_key((u32 *)state,
-			      (u32 *)expkey + round * AES_STATECOLS);
+/* one forward round for output column c, taking row r from column c + r */
+#define AES_EROUND(s0, s1, s2, s3, k) \
+	(te[(s0) & 0xff] ^ aes_rol(te[((s1) >> 8) & 0xff], 8) ^ \
+	 aes_rol(te[((s2) >> 16) & 0xff], 16) ^ aes_rol(te[(s3) >> 24], 24) ^ \
+	 (k))
+
+#define AES_ELAST(s0, s1, s2, s3, k) \
+	((sbox[(s0) & 0xff] | sbox[((s1) >> 8) & 0xff] << 8 | \
+	  sbox[((s2) >> 16) & 0xff] << 16 | (u32)sbox[(s3) >> 24] << 24) ^ (k))
+
+/* one inverse round for output column c, taking row r from column c - r */
+#define AES_DROUND(s0, s1, s2, s3, k) \
+	(td[(s0) & 0xff] ^ aes_rol(td[((s1) >> 8) & 0xff], 8) ^ \
+	 aes_rol(td[((s2) >> 16) & 0xff], 16) ^ aes_rol(td[(s3) >> 24], 24) ^ \
+	 (k))
+
+#define AES_DLAST(s0, s1, s2, s3, k) \
+	((inv_sbox[(s0) & 0xff] | inv_sbox[((s1) >> 8) & 0xff] << 8 | \
+	  inv_sbox[((s2) >> 16) & 0xff] << 16 | \
+	  (u32)inv_sbox[(s3) >> 24] << 24) ^ (k))
+
+static void aes_encrypt_block(const u32 *rk, u32 rounds, const u8 *in,
+			      u8 *out)
+{
+	u32 s0, s1, s2, s3, t0, t1, t2, t3;
+	u32 round;
+
+	s0 = aes_get_le32(in) ^ rk[0];
+	s1 = aes_get_le32(in + 4) ^ rk[1];
+	s2 = aes_get_le32(in + 8) ^ rk[2];
+	s3 = aes_get_le32(in + 12) ^ rk[3];
+
+	for (round = 1; round < rounds; round++) {
+		rk += AES_STATECOLS;
+		t0 = AES_EROUND(s0, s1, s2, s3, rk[0]);
+		t1 = AES_EROUND(s1, s2, s3, s0, rk[1]);
+		t2 = AES_EROUND(s2, s3, s0, s1, rk[2]);
+		t3 = AES_EROUND(s3, s0, s1, s2, rk[3]);
+		s0 = t0;
+		s1 = t1;
+		s2 = t2;
+		s3 = t3;
 	}
 
-	memcpy(out, state, sizeof(state));
+	rk += AES_STATECOLS;
+	aes_put_le32(out, AES_ELAST(s0, s1, s2, s3, rk[0]));
+	aes_put_le32(out + 4, AES_ELAST(s1, s2, s3, s0, rk[1]));
+	aes_put_le32(out + 8, AES_ELAST(s2, s3, s0, s1, rk[2]));
+	aes_put_le32(out + 12, AES_ELAST(s3, s0, s1, s2, rk[3]));
 }
 
-void aes_decrypt(u32 key_len, u8 *in, u8 *expkey, u8 *out)
+static void aes_decrypt_block(const u32 *dk, u32 rounds, const u8 *in,
+			      u8 *out)
 {
-	u8 state[AES_STATECOLS * 4];
-	int round, aes_rounds;
+	u32 s0, s1, s2, s3, t0, t1, t2, t3;
+	u32 round;
+
+	s0 = aes_get_le32(in) ^ dk[0];
+	s1 = aes_get_le32(in + 4) ^ dk[1];
+	s2 = aes_get_le32(in + 8) ^ dk[2];
+	s3 = aes_get_le32(in + 12) ^ dk[3];
+
+	for (round = 1; round < rounds; round++) {
+		dk += AES_STATECOLS;
+		t0 = AES_DROUND(s0, s3, s2, s1, dk[0]);
+		t1 = AES_DROUND(s1, s0, s3, s2, dk[1]);
+		t2 = AES_DROUND(s2, s1, s0, s3, dk[2]);
+		t3 = AES_DROUND(s3, s2, s1, s0, dk[3]);
+		s0 = t0;
+		s1 = t1;
+		s2 = t2;
+		s3 = t3;
+	}
 
-	aes_rounds = aes_get_rounds(key_len);
+	dk += AES_STATECOLS;
+	aes_put_le32(out, AES_DLAST(s0, s3, s2, s1, dk[0]));
+	aes_put_le32(out + 4, AES_DLAST(s1, s0, s3, s2, dk[1]));
+	aes_put_le32(out + 8, AES_DLAST(s2, s1, s0, s3, dk[2]));
+	aes_put_le32(out + 12, AES_DLAST(s3, s2, s1, s0, dk[3]));
+}
 
-	memcpy(state, in, sizeof(state));
+/* encrypt one 128 bit block */
+void aes_encrypt(u32 key_len, u8 *in, u8 *expkey, u8 *out)
+{
+	u32 rk[AES_MAX_RK_WORDS];
+	u32 rounds = aes_get_rounds(key_len);
 
-	add_round_key((u32 *)state,
-		      (u32 *)expkey + aes_rounds * AES_STATECOLS);
-	inv_shift_rows(state);
+	aes_load_enc_key(rk, expkey, rounds);
+	aes_encrypt_block(rk, rounds, in, out);
+}
 
-	for (round = aes_rounds; round--; ) {
-		add_round_key((u32 *)state,
-			      (u32 *)expkey + round * AES_STATECOLS);
-		if (round)
-			inv_mix_sub_columns(state);
-	}
+void aes_decrypt(u32 key_len, u8 *in, u8 *expkey, u8 *out)
+{
+	u32 dk[AES_MAX_RK_WORDS];
+	u32 rounds = aes_get_rounds(key_len);
 
-	memcpy(out, state, sizeof(state));
+	aes_load_dec_key(dk, expkey, rounds);
+	aes_decrypt_block(dk, rounds, in, out);
 }
 
 static void debug_print_vector(char *name, u32 num_bytes, u8 *data)
@@ -638,8 +481,11 @@ void aes_cbc_encrypt_blocks(u32 key_len, u8 *key_exp, u8 *iv, u8 *src, u8 *dst,
 {
 	u8 tmp_data[AES_BLOCK_LENGTH];
 	u8 *cbc_chain_data = iv;
+	u32 rk[AES_MAX_RK_WORDS];
+	u32 rounds = aes_get_rounds(key_len);
 	u32 i;
 
+	aes_load_enc_key(rk, key_exp, rounds);
 	for (i = 0; i < num_aes_blocks; i++) {
 		debug("encrypt_object: block %d of %d\n", i, num_aes_blocks);
 		debug_print_vector("AES Src", AES_BLOCK_LENGTH, src);
@@ -649,7 +495,7 @@ void aes_cbc_encrypt_blocks(u32 key_len, u8 *key_exp, u8 *iv, u8 *src, u8 *dst,
 		debug_print_vector("AES Xor", AES_BLOCK_LENGTH, tmp_data);
 
 		/* Encrypt the AES block */
-		aes_encrypt(key_len, tmp_data, key_exp, dst);
+		aes_encrypt_block(rk, rounds, tmp_data, dst);
 		debug_print_vector("AES Dst", AES_BLOCK_LENGTH, dst);
 
 		/* Update pointers for next loop. */
@@ -665,8 +511,11 @@ void aes_cbc_decrypt_blocks(u32 key_len, u8 *key_exp, u8 *iv, u8 *src, u8 *dst,
 	u8 tmp_data[AES_BLOCK_LENGTH], tmp_block[AES_BLOCK_LENGTH];
 	/* Convenient array of 0's for IV */
 	u8 cbc_chain_data[AES_BLOCK_LENGTH];
+	u32 dk[AES_MAX_RK_WORDS];
+	u32 rounds = aes_get_rounds(key_len);
 	u32 i;
 
+	aes_load_dec_key(dk, key_exp, rounds);
 	memcpy(cbc_chain_data, iv, AES_BLOCK_LENGTH);
 	for (i = 0; i < num_aes_blocks; i++) {
 		debug("encrypt_object: block %d of %d\n", i, num_aes_blocks);
@@ -675,7 +524,7 @@ void aes_cbc_decrypt_blocks(u32 key_len, u8 *key_exp, u8 *iv, u8 *src, u8 *dst,
 		memcpy(tmp_block, src, AES_BLOCK_LENGTH);
 
 		/* Decrypt the AES block */
-		aes_decrypt(key_len, src, key_exp, tmp_data);
+		aes_decrypt_block(dk, rounds, src, tmp_data);
 		debug_print_vector("AES Xor", AES_BLOCK_LENGTH, tmp_data);
 
 		/* Apply the chain data */
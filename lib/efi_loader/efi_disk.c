@@ -153,6 +153,73 @@ static efi_status_t efi_disk_rw_blocks(struct efi_block_io *this,
 	return EFI_SUCCESS;
 }
 
+/**
+ * efi_disk_transfer() - transfer blocks, bouncing only where needed
+ *
+ * With CONFIG_EFI_LOADER_BOUNCE_BUFFER the hardware can only reach memory
+ * up to EFI_LOADER_BOUNCE_BUFFER_LIMIT. The part of @buffer below this
+ * limit is used for the transfer directly, only the part above it is
+ * copied through efi_bounce_buffer.
+ *
+ * @this:		pointer to the BLOCK_IO_PROTOCOL
+ * @media_id:		id of the medium
+ * @lba:		starting logical block
+ * @buffer_size:	size of the buffer, a multiple of the block size
+ * @buffer:		buffer aligned to the block size
+ * @direction:		direction of the transfer
+ * Return:		status code
+ */
+static efi_status_t efi_disk_transfer(struct efi_block_io *this,
+				      u32 media_id, u64 lba,
+				      efi_uintn_t buffer_size, void *buffer,
+				      enum efi_disk_direction direction)
+{
+#ifdef CONFIG_EFI_LOADER_BOUNCE_BUFFER
+	u32 blksz = this->media->block_size;
+	void *real_buffer;
+	efi_uintn_t len;
+	efi_status_t r;
+
+	if (buffer_size & (blksz - 1))
+		return EFI_BAD_BUFFER_SIZE;
+
+	while (buffer_size) {
+		/*
+		 * The limit is one below a multiple of the block size, so
+		 * each part is made of whole blocks
+		 */
+		if ((uintptr_t)buffer <= EFI_LOADER_BOUNCE_BUFFER_LIMIT) {
+			len = min_t(u64, buffer_size,
+				    EFI_LOADER_BOUNCE_BUFFER_LIMIT -
+				    (uintptr_t)buffer + 1);
+			real_buffer = buffer;
+		} else {
+			len = min_t(efi_uintn_t, buffer_size,
+				    EFI_LOADER_BOUNCE_BUFFER_SIZE);
+			real_buffer = efi_bounce_buffer;
+			if (direction == EFI_DISK_WRITE)
+				memcpy(real_buffer, buffer, len);
+		}
+
+		r = efi_disk_rw_blocks(this, media_id, lba, len, real_buffer,
+				       direction);
+		if (r != EFI_SUCCESS)
+			return r;
+		if (direction == EFI_DISK_READ && real_buffer != buffer)
+			memcpy(buffer, real_buffer, len);
+
+		buffer += len;
+		buffer_size -= len;
+		lba += len / blksz;
+	}
+
+	return EFI_SUCCESS;
+#else
+	return efi_disk_rw_blocks(this, media_id, lba, buffer_size, buffer,
+				  direction);
+#endif
+}
+
 /**
  * efi_disk_read_blocks() - reads blocks from device
  *
@@ -172,7 +239,6 @@ static efi_status_t EFIAPI efi_disk_read_blocks(struct efi_block_io *this,
 			u32 media_id, u64 lba, efi_uintn_t buffer_size,
 			void *buffer)
 {
-	void *real_buffer = buffer;
 	efi_status_t r;
 
 	if (!this)
@@ -190,30 +256,11 @@ static efi_status_t EFIAPI efi_disk_read_blocks(struct efi_block_io *this,
 	    (this->media->last_block + 1) * this->media->block_size)
 		return EFI_INVALID_PARAMETER;
 
-#ifdef CONFIG_EFI_LOADER_BOUNCE_BUFFER
-	if (buffer_size > EFI_LOADER_BOUNCE_BUFFER_SIZE) {
-		r = efi_disk_read_blocks(this, media_id, lba,
-			EFI_LOADER_BOUNCE_BUFFER_SIZE, buffer);
-		if (r != EFI_SUCCESS)
-			return r;
-		return efi_disk_read_blocks(this, media_id, lba +
-			EFI_LOADER_BOUNCE_BUFFER_SIZE / this->media->block_size,
-			buffer_size - EFI_LOADER_BOUNCE_BUFFER_SIZE,
-			buffer + EFI_LOADER_BOUNCE_BUFFER_SIZE);
-	}
-
-	real_buffer = efi_bounce_buffer;
-#endif
-
 	EFI_ENTRY("%p, %x, %llx, %zx, %p", this, media_id, lba,
 		  buffer_size, buffer);
 
-	r = efi_disk_rw_blocks(this, media_id, lba, buffer_size, real_buffer,
-			       EFI_DISK_READ);
-
-	/* Copy from bounce buffer to real buffer if necessary */
-	if ((r == EFI_SUCCESS) && (real_buffer != buffer))
-		memcpy(buffer, real_buffer, buffer_size);
+	r = efi_disk_transfer(this, media_id, lba, buffer_size, buffer,
+			      EFI_DISK_READ);
 
 	return EFI_EXIT(r);
 }
@@ -238,7 +285,6 @@ static efi_status_t EFIAPI efi_disk_write_blocks(struct efi_block_io *this,
 			u32 media_id, u64 lba, efi_uintn_t buffer_size,
 			void *buffer)
 {
-	void *real_buffer = buffer;
 	efi_status_t r;
 
 	if (!this)
@@ -258,30 +304,11 @@ static efi_status_t EFIAPI efi_disk_write_blocks(struct efi_block_io *this,
 	    (this->media->last_block + 1) * this->media->block_size)
 		return EFI_INVALID_PARAMETER;
 
-#ifdef CONFIG_EFI_LOADER_BOUNCE_BUFFER
-	if (buffer_size > EFI_LOADER_BOUNCE_BUFFER_SIZE) {
-		r = efi_disk_write_blocks(this, media_id, lba,
-			EFI_LOADER_BOUNCE_BUFFER_SIZE, buffer);
-		if (r != EFI_SUCCESS)
-			return r;
-		return efi_disk_write_blocks(this, media_id, lba +
-			EFI_LOADER_BOUNCE_BUFFER_SIZE / this->media->block_size,
-			buffer_size - EFI_LOADER_BOUNCE_BUFFER_SIZE,
-			buffer + EFI_LOADER_BOUNCE_BUFFER_SIZE);
-	}
-
-	real_buffer = efi_bounce_buffer;
-#endif
-
 	EFI_ENTRY("%p, %x, %llx, %zx, %p", this, media_id, lba,
 		  buffer_size, buffer);
 
-	/* Populate bounce buffer if necessary */
-	if (real_buffer != buffer)
-		memcpy(real_buffer, buffer, buffer_size);
-
-	r = efi_disk_rw_blocks(this, media_id, lba, buffer_size, real_buffer,
-			       EFI_DISK_WRITE);
+	r = efi_disk_transfer(this, media_id, lba, buffer_size, buffer,
+			      EFI_DISK_WRITE);
 
 	return EFI_EXIT(r);
 }
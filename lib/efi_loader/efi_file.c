@@ -53,6 +53,11 @@ static char *basename(struct file_handle *fh)
 	return fh->path;
 }
 
+/*
+ * Select the file system of the handle. This is done before each operation,
+ * as fs_close() is implied by most of them; with CONFIG_FS_MOUNT_CACHE the
+ * file system stays mounted in between, so this is cheap.
+ */
 static int set_blk_dev(struct file_handle *fh)
 {
 	return fs_set_blk_dev_with_part(fh->fs->desc, fh->fs->part);
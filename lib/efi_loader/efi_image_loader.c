@@ -12,6 +12,7 @@
 #include <common.h>
 #include <cpu_func.h>
 #include <efi_loader.h>
+#include <hash.h>
 #include <log.h>
 #include <malloc.h>
 #include <pe.h>
@@ -19,6 +20,7 @@
 #include <crypto/mscode.h>
 #include <crypto/pkcs7_parser.h>
 #include <linux/err.h>
+#include <linux/sizes.h>
 
 const efi_guid_t efi_global_variable_guid = EFI_GLOBAL_VARIABLE_GUID;
 const efi_guid_t efi_guid_device_path = EFI_DEVICE_PATH_PROTOCOL_GUID;
@@ -516,6 +518,151 @@ err:
 	return false;
 }
 
+/* Size of the pieces of an image passed to each hash algorithm in turn */
+#define EFI_IMAGE_HASH_CHUNK	SZ_64K
+
+/**
+ * efi_image_find_digest() - find a digest computed before
+ * @regs:	Regions of the image
+ * @algo:	Name of the hash algorithm
+ *
+ * Return:	digest or NULL if not computed yet
+ */
+static struct efi_image_digest *
+efi_image_find_digest(struct efi_image_regions *regs, const char *algo)
+{
+	int i;
+
+	for (i = 0; i < regs->num_digests; i++) {
+		if (!strcmp(regs->digests[i].algo, algo))
+			return &regs->digests[i];
+	}
+
+	return NULL;
+}
+
+/**
+ * efi_image_hash() - compute digests of the regions of an image
+ * @regs:	Regions of the image, see efi_image_parse()
+ * @algos:	Names of the hash algorithms, e.g. "sha256"
+ * @count:	Number of entries in @algos
+ *
+ * The digests which are not held in @regs yet are computed in a single
+ * pass over the regions: each chunk of the image is passed to all hash
+ * algorithms while it is still in the cache. The digests are kept in
+ * @regs, so authentication and measurement of an image digest it only
+ * once per algorithm.
+ *
+ * Return:	0 if OK, -ENOSPC if @regs cannot hold more digests, other -ve
+ *		on error
+ */
+int efi_image_hash(struct efi_image_regions *regs, const char *const algos[],
+		   int count)
+{
+	struct hash_algo *algo[EFI_IMAGE_MAX_DIGESTS];
+	void *ctx[EFI_IMAGE_MAX_DIGESTS];
+	struct efi_image_digest *digest;
+	int i, j, num = 0, ret = 0;
+	const u8 *data;
+	size_t len, left;
+	bool last;
+
+	for (i = 0; i < count; i++) {
+		if (efi_image_find_digest(regs, algos[i]))
+			continue;
+		for (j = 0; j < num; j++) {
+			if (!strcmp(algo[j]->name, algos[i]))
+				break;
+		}
+		if (j < num)
+			continue;
+		if (regs->num_digests + num >= EFI_IMAGE_MAX_DIGESTS) {
+			ret = -ENOSPC;
+			goto out;
+		}
+		ret = hash_progressive_lookup_algo(algos[i], &algo[num]);
+		if (ret)
+			goto out;
+		if (algo[num]->digest_size > HASH_MAX_DIGEST_SIZE) {
+			ret = -EINVAL;
+			goto out;
+		}
+		ret = algo[num]->hash_init(algo[num], &ctx[num]);
+		if (ret)
+			goto out;
+		num++;
+	}
+	if (!num)
+		return 0;
+
+	for (i = 0; i < regs->num; i++) {
+		data = regs->reg[i].data;
+		left = regs->reg[i].size;
+		do {
+			len = min_t(size_t, left, EFI_IMAGE_HASH_CHUNK);
+			left -= len;
+			last = i == regs->num - 1 && !left;
+			for (j = 0; j < num; j++) {
+				ret = algo[j]->hash_update(algo[j], ctx[j],
+							   data, len, last);
+				if (ret)
+					goto out;
+			}
+			data += len;
+		} while (left);
+	}
+
+	for (j = 0; j < num; j++) {
+		digest = &regs->digests[regs->num_digests];
+		ret = algo[j]->hash_finish(algo[j], ctx[j], digest->value,
+					   algo[j]->digest_size);
+		/* hash_finish() releases the context */
+		ctx[j] = NULL;
+		if (ret)
+			goto out;
+		digest->algo = algo[j]->name;
+		digest->len = algo[j]->digest_size;
+		regs->num_digests++;
+	}
+
+out:
+	for (j = 0; j < num; j++)
+		free(ctx[j]);
+
+	return ret;
+}
+
+/**
+ * efi_image_digest() - get a digest of the regions of an image
+ * @regs:	Regions of the image, see efi_image_parse()
+ * @algo:	Name of the hash algorithm, e.g. "sha256"
+ * @len:	On return, length of the digest
+ *
+ * The digest is computed by efi_image_hash() unless @regs already holds it.
+ *
+ * Return:	digest or NULL on error
+ */
+const u8 *efi_image_digest(struct efi_image_regions *regs, const char *algo,
+			   int *len)
+{
+	struct efi_image_digest *digest;
+
+	if (!algo)
+		return NULL;
+
+	digest = efi_image_find_digest(regs, algo);
+	if (!digest) {
+		if (efi_image_hash(regs, &algo, 1))
+			return NULL;
+		digest = efi_image_find_digest(regs, algo);
+		if (!digest)
+			return NULL;
+	}
+	*len = digest->len;
+
+	return digest->value;
+}
+
 #ifdef CONFIG_EFI_SECURE_BOOT
 /**
  * efi_image_verify_digest - verify image's message digest
@@ -532,7 +679,7 @@ static bool efi_image_verify_digest(struct efi_image_regions *regs,
 				    struct pkcs7_message *msg)
 {
 	struct pefile_context ctx;
-	void *hash;
+	const u8 *hash;
 	int hash_len, ret;
 
 	const void *data;
@@ -549,10 +696,9 @@ static bool efi_image_verify_digest(struct efi_image_regions *regs,
 	if (ret < 0)
 		return false;
 
-	/* calculate a hash value of PE image */
-	hash = NULL;
-	if (!efi_hash_regions(regs->reg, regs->num, &hash, ctx.digest_algo,
-			      &hash_len))
+	/* calculate a hash value of PE image, unless done before */
+	hash = efi_image_digest(regs, ctx.digest_algo, &hash_len);
+	if (!hash)
 		return false;
 
 	/* match the digest */
@@ -564,8 +710,9 @@ static bool efi_image_verify_digest(struct efi_image_regions *regs,
 
 /**
  * efi_image_authenticate() - verify a signature of signed image
- * @efi:	Pointer to image
- * @efi_size:	Size of @efi
+ * @regs:	Regions of the image to digest, NULL if parsing failed
+ * @wincerts:	Certificate table of the image
+ * @wincerts_len:	Size of @wincerts
  *
  * A signed image should have its signature stored in a table of its PE header.
  * So if an image is signed and only if if its signature is verified using
@@ -583,14 +730,13 @@ static bool efi_image_verify_digest(struct efi_image_regions *regs,
  *
  * Return:	true if authenticated, false if not
  */
-static bool efi_image_authenticate(void *efi, size_t efi_size)
+static bool efi_image_authenticate(struct efi_image_regions *regs,
+				   WIN_CERTIFICATE *wincerts,
+				   size_t wincerts_len)
 {
-	struct efi_image_regions *regs = NULL;
-	WIN_CERTIFICATE *wincerts = NULL, *wincert;
-	size_t wincerts_len;
+	WIN_CERTIFICATE *wincert;
 	struct pkcs7_message *msg = NULL;
 	struct efi_signature_store *db = NULL, *dbx = NULL;
-	void *new_efi = NULL;
 	u8 *auth, *wincerts_end;
 	size_t auth_size;
 	bool ret = false;
@@ -600,14 +746,9 @@ static bool efi_image_authenticate(void *efi, size_t efi_size)
 	if (!efi_secure_boot_enabled())
 		return true;
 
-	new_efi = efi_prepare_aligned_image(efi, (u64 *)&efi_size);
-	if (!new_efi)
-		return false;
-
-	if (!efi_image_parse(new_efi, efi_size, &regs, &wincerts,
-			     &wincerts_len)) {
+	if (!regs) {
 		log_err("Parsing PE executable image failed\n");
-		goto out;
+		return false;
 	}
 
 	/*
@@ -752,15 +893,14 @@ out:
 	efi_sigstore_free(db);
 	efi_sigstore_free(dbx);
 	pkcs7_free_message(msg);
-	free(regs);
-	if (new_efi != efi)
-		free(new_efi);
 
 	log_debug("%s: Exit, %d\n", __func__, ret);
 	return ret;
 }
 #else
-static bool efi_image_authenticate(void *efi, size_t efi_size)
+static bool efi_image_authenticate(struct efi_image_regions *regs,
+				   WIN_CERTIFICATE *wincerts,
+				   size_t wincerts_len)
 {
 	return true;
 }
@@ -851,6 +991,11 @@ efi_status_t efi_load_pe(struct efi_loaded_image_obj *handle,
 	uint64_t image_base;
 	unsigned long virt_size = 0;
 	int supported = 0;
+	struct efi_image_regions *regs = NULL;
+	WIN_CERTIFICATE *wincerts = NULL;
+	size_t wincerts_len = 0;
+	void *aligned_efi = efi;
+	u64 aligned_size = efi_size;
 	efi_status_t ret;
 
 	ret = efi_check_pe(efi, efi_size, (void **)&nt);
@@ -881,8 +1026,24 @@ efi_status_t efi_load_pe(struct efi_loaded_image_obj *handle,
 		return EFI_LOAD_ERROR;
 	}
 
+	/*
+	 * Authentication and measurement digest the same regions of the
+	 * image. Parse it only once, the digests are kept with the regions.
+	 */
+	if (efi_secure_boot_enabled() ||
+	    IS_ENABLED(CONFIG_EFI_TCG2_PROTOCOL)) {
+		aligned_efi = efi_prepare_aligned_image(efi, &aligned_size);
+		if (!aligned_efi) {
+			aligned_efi = efi;
+			ret = EFI_OUT_OF_RESOURCES;
+			goto err;
+		}
+		efi_image_parse(aligned_efi, aligned_size, &regs, &wincerts,
+				&wincerts_len);
+	}
+
 	/* Authenticate an image */
-	if (efi_image_authenticate(efi, efi_size)) {
+	if (efi_image_authenticate(regs, wincerts, wincerts_len)) {
 		handle->auth_status = EFI_IMAGE_AUTH_PASSED;
 	} else {
 		handle->auth_status = EFI_IMAGE_AUTH_FAILED;
@@ -940,7 +1101,8 @@ efi_status_t efi_load_pe(struct efi_loaded_image_obj *handle,
 
 #if IS_ENABLED(CONFIG_EFI_TCG2_PROTOCOL)
 	/* Measure an PE/COFF image */
-	ret = tcg2_measure_pe_image(efi, efi_size, handle, loaded_image_info);
+	ret = tcg2_measure_pe_image(efi, efi_size, regs, handle,
+				    loaded_image_info);
 	if (ret == EFI_SECURITY_VIOLATION) {
 		/*
 		 * TCG2 Protocol is installed but no TPM device found,
@@ -993,10 +1155,14 @@ efi_status_t efi_load_pe(struct efi_loaded_image_obj *handle,
 	loaded_image_info->image_size = virt_size;
 
 	if (handle->auth_status == EFI_IMAGE_AUTH_PASSED)
-		return EFI_SUCCESS;
+		ret = EFI_SUCCESS;
 	else
-		return EFI_SECURITY_VIOLATION;
+		ret = EFI_SECURITY_VIOLATION;
 
 err:
+	free(regs);
+	if (aligned_efi != efi)
+		free(aligned_efi);
+
 	return ret;
 }
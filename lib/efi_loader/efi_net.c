@@ -26,12 +26,16 @@ static const efi_guid_t efi_pxe_base_code_protocol_guid =
 static struct efi_pxe_packet *dhcp_ack;
 static void *new_tx_packet;
 static void *transmit_buffer;
-static uchar **receive_buffer;
+/* Ring of received packets, each taking PKTSIZE_ALIGN bytes */
+static uchar *receive_buffer;
 static size_t *receive_lengths;
 static int rx_packet_idx;
 static int rx_packet_num;
+static struct efi_network_statistics net_stats;
 static struct efi_net_obj *netobj;
 
+#define EFI_NET_RX_PACKETS CONFIG_EFI_NET_RX_PACKETS
+
 /*
  * The notification function of this event is called in every timer cycle
  * to check if a new network packet has been received.
@@ -316,6 +320,71 @@ static efi_status_t EFIAPI efi_net_station_address
 	return EFI_EXIT(EFI_UNSUPPORTED);
 }
 
+/**
+ * efi_net_rx_packet() - get a slot of the receive ring
+ *
+ * @idx:	index of the slot
+ * Return:	buffer for the packet
+ */
+static uchar *efi_net_rx_packet(int idx)
+{
+	return receive_buffer + idx * PKTSIZE_ALIGN;
+}
+
+/**
+ * efi_net_count_dest() - count a packet by its type of destination
+ *
+ * @pkt:	Ethernet packet
+ * @rx:		true for a received packet, false for a transmitted one
+ */
+static void efi_net_count_dest(const void *pkt, bool rx)
+{
+	const struct ethernet_hdr *eth_hdr = pkt;
+
+	if (is_broadcast_ethaddr(eth_hdr->et_dest)) {
+		if (rx)
+			net_stats.rx_broadcast_frames++;
+		else
+			net_stats.tx_broadcast_frames++;
+	} else if (is_multicast_ethaddr(eth_hdr->et_dest)) {
+		if (rx)
+			net_stats.rx_multicast_frames++;
+		else
+			net_stats.tx_multicast_frames++;
+	} else {
+		if (rx)
+			net_stats.rx_unicast_frames++;
+		else
+			net_stats.tx_unicast_frames++;
+	}
+}
+
+/**
+ * efi_net_reset_statistics() - reset the statistics of the network interface
+ *
+ * Statistics which are not collected are set to all ones.
+ */
+static void efi_net_reset_statistics(void)
+{
+	memset(&net_stats, 0xff, sizeof(net_stats));
+	net_stats.rx_total_frames = 0;
+	net_stats.rx_good_frames = 0;
+	net_stats.rx_undersize_frames = 0;
+	net_stats.rx_oversize_frames = 0;
+	net_stats.rx_dropped_frames = 0;
+	net_stats.rx_unicast_frames = 0;
+	net_stats.rx_broadcast_frames = 0;
+	net_stats.rx_multicast_frames = 0;
+	net_stats.rx_total_bytes = 0;
+	net_stats.tx_total_frames = 0;
+	net_stats.tx_good_frames = 0;
+	net_stats.tx_oversize_frames = 0;
+	net_stats.tx_unicast_frames = 0;
+	net_stats.tx_broadcast_frames = 0;
+	net_stats.tx_multicast_frames = 0;
+	net_stats.tx_total_bytes = 0;
+}
+
 /*
  * efi_net_statistics() - reset or collect statistics of the network interface
  *
@@ -333,9 +402,46 @@ static efi_status_t EFIAPI efi_net_statistics(struct efi_simple_network *this,
 					      int reset, ulong *stat_size,
 					      void *stat_table)
 {
+	efi_status_t ret = EFI_SUCCESS;
+
 	EFI_ENTRY("%p, %x, %p, %p", this, reset, stat_size, stat_table);
 
-	return EFI_EXIT(EFI_UNSUPPORTED);
+	/* Check parameters */
+	if (!this) {
+		ret = EFI_INVALID_PARAMETER;
+		goto out;
+	}
+
+	switch (this->mode->state) {
+	case EFI_NETWORK_STOPPED:
+		ret = EFI_NOT_STARTED;
+		goto out;
+	case EFI_NETWORK_STARTED:
+		ret = EFI_DEVICE_ERROR;
+		goto out;
+	default:
+		break;
+	}
+
+	if (stat_size) {
+		if (!stat_table) {
+			ret = EFI_INVALID_PARAMETER;
+			goto out;
+		}
+		/* Copy as much of the table as fits */
+		memcpy(stat_table, &net_stats,
+		       min_t(ulong, *stat_size, sizeof(net_stats)));
+		if (*stat_size < sizeof(net_stats))
+			ret = EFI_BUFFER_TOO_SMALL;
+		*stat_size = sizeof(net_stats);
+	} else if (!reset) {
+		ret = EFI_INVALID_PARAMETER;
+		goto out;
+	}
+	if (reset)
+		efi_net_reset_statistics();
+out:
+	return EFI_EXIT(ret);
 }
 
 /*
@@ -509,6 +615,7 @@ static efi_status_t EFIAPI efi_net_transmit
 
 	/* We do not support jumbo packets */
 	if (buffer_size > PKTSIZE_ALIGN) {
+		net_stats.tx_oversize_frames++;
 		ret = EFI_INVALID_PARAMETER;
 		goto out;
 	}
@@ -555,6 +662,11 @@ static efi_status_t EFIAPI efi_net_transmit
 	memcpy(transmit_buffer, buffer, buffer_size);
 	net_send_packet(transmit_buffer, buffer_size);
 
+	net_stats.tx_total_frames++;
+	net_stats.tx_good_frames++;
+	net_stats.tx_total_bytes += buffer_size;
+	efi_net_count_dest(buffer, false);
+
 	new_tx_packet = buffer;
 	this->int_status |= EFI_SIMPLE_NETWORK_TRANSMIT_INTERRUPT;
 out:
@@ -585,6 +697,7 @@ static efi_status_t EFIAPI efi_net_receive
 	efi_status_t ret = EFI_SUCCESS;
 	struct ethernet_hdr *eth_hdr;
 	size_t hdr_size = sizeof(struct ethernet_hdr);
+	uchar *packet;
 	u16 protlen;
 
 	EFI_ENTRY("%p, %p, %p, %p, %p, %p, %p", this, header_size,
@@ -615,11 +728,12 @@ static efi_status_t EFIAPI efi_net_receive
 		goto out;
 	}
 	/* Fill export parameters */
-	eth_hdr = (struct ethernet_hdr *)receive_buffer[rx_packet_idx];
+	packet = efi_net_rx_packet(rx_packet_idx);
+	eth_hdr = (struct ethernet_hdr *)packet;
 	protlen = ntohs(eth_hdr->et_protlen);
 	if (protlen == 0x8100) {
 		hdr_size += 4;
-		protlen = ntohs(*(u16 *)&receive_buffer[rx_packet_idx][hdr_size - 2]);
+		protlen = ntohs(*(u16 *)&packet[hdr_size - 2]);
 	}
 	if (header_size)
 		*header_size = hdr_size;
@@ -636,10 +750,9 @@ static efi_status_t EFIAPI efi_net_receive
 		goto out;
 	}
 	/* Copy packet */
-	memcpy(buffer, receive_buffer[rx_packet_idx],
-	       receive_lengths[rx_packet_idx]);
+	memcpy(buffer, packet, receive_lengths[rx_packet_idx]);
 	*buffer_size = receive_lengths[rx_packet_idx];
-	rx_packet_idx = (rx_packet_idx + 1) % ETH_PACKETS_BATCH_RECV;
+	rx_packet_idx = (rx_packet_idx + 1) % EFI_NET_RX_PACKETS;
 	rx_packet_num--;
 	if (rx_packet_num)
 		wait_for_packet->is_signaled = true;
@@ -685,24 +798,34 @@ static void efi_net_push(void *pkt, int len)
 {
 	int rx_packet_next;
 
+	net_stats.rx_total_frames++;
+
 	/* Check that we at least received an Ethernet header */
-	if (len < sizeof(struct ethernet_hdr))
+	if (len < sizeof(struct ethernet_hdr)) {
+		net_stats.rx_undersize_frames++;
 		return;
+	}
 
 	/* Check that the buffer won't overflow */
-	if (len > PKTSIZE_ALIGN)
+	if (len > PKTSIZE_ALIGN) {
+		net_stats.rx_oversize_frames++;
 		return;
+	}
 
 	/* Can't store more than pre-alloced buffer */
-	if (rx_packet_num >= ETH_PACKETS_BATCH_RECV)
+	if (rx_packet_num >= EFI_NET_RX_PACKETS) {
+		net_stats.rx_dropped_frames++;
 		return;
+	}
 
-	rx_packet_next = (rx_packet_idx + rx_packet_num) %
-	    ETH_PACKETS_BATCH_RECV;
-	memcpy(receive_buffer[rx_packet_next], pkt, len);
+	rx_packet_next = (rx_packet_idx + rx_packet_num) % EFI_NET_RX_PACKETS;
+	memcpy(efi_net_rx_packet(rx_packet_next), pkt, len);
 	receive_lengths[rx_packet_next] = len;
 
 	rx_packet_num++;
+	net_stats.rx_good_frames++;
+	net_stats.rx_total_bytes += len;
+	efi_net_count_dest(pkt, true);
 }
 
 /**
@@ -727,15 +850,24 @@ static void EFIAPI efi_network_timer_notify(struct efi_event *event,
 	if (!this || this->mode->state != EFI_NETWORK_INITIALIZED)
 		goto out;
 
-	if (!rx_packet_num) {
-		push_packet = efi_net_push;
+	/*
+	 * eth_rx() passes up to ETH_PACKETS_BATCH_RECV packets. Poll while
+	 * a whole batch fits into the ring and the device kept delivering
+	 * full batches.
+	 */
+	push_packet = efi_net_push;
+	while (EFI_NET_RX_PACKETS - rx_packet_num >= ETH_PACKETS_BATCH_RECV) {
+		u64 rx_total = net_stats.rx_total_frames;
+
 		eth_rx();
-		push_packet = NULL;
-		if (rx_packet_num) {
-			this->int_status |=
-				EFI_SIMPLE_NETWORK_RECEIVE_INTERRUPT;
-			wait_for_packet->is_signaled = true;
-		}
+		if (net_stats.rx_total_frames - rx_total <
+		    ETH_PACKETS_BATCH_RECV)
+			break;
+	}
+	push_packet = NULL;
+	if (rx_packet_num) {
+		this->int_status |= EFI_SIMPLE_NETWORK_RECEIVE_INTERRUPT;
+		wait_for_packet->is_signaled = true;
 	}
 out:
 	EFI_EXIT(EFI_SUCCESS);
@@ -861,7 +993,6 @@ static efi_status_t EFIAPI efi_pxe_base_code_set_packets(
 efi_status_t efi_net_register(void)
 {
 	efi_status_t r;
-	int i;
 
 	if (!eth_get_dev()) {
 		/* No network device active, don't expose any */
@@ -879,20 +1010,15 @@ efi_status_t efi_net_register(void)
 		goto out_of_resources;
 	transmit_buffer = (void *)ALIGN((uintptr_t)transmit_buffer, PKTALIGN);
 
-	/* Allocate a number of receive buffers */
-	receive_buffer = calloc(ETH_PACKETS_BATCH_RECV,
-				sizeof(*receive_buffer));
+	/* Allocate the receive ring */
+	receive_buffer = malloc(EFI_NET_RX_PACKETS * PKTSIZE_ALIGN);
 	if (!receive_buffer)
 		goto out_of_resources;
-	for (i = 0; i < ETH_PACKETS_BATCH_RECV; i++) {
-		receive_buffer[i] = malloc(PKTSIZE_ALIGN);
-		if (!receive_buffer[i])
-			goto out_of_resources;
-	}
-	receive_lengths = calloc(ETH_PACKETS_BATCH_RECV,
+	receive_lengths = calloc(EFI_NET_RX_PACKETS,
 				 sizeof(*receive_lengths));
 	if (!receive_lengths)
 		goto out_of_resources;
+	efi_net_reset_statistics();
 
 	/* Hook net up to the device list */
 	efi_add_handle(&netobj->header);
@@ -990,9 +1116,6 @@ out_of_resources:
 	free(netobj);
 	netobj = NULL;
 	free(transmit_buffer);
-	if (receive_buffer)
-		for (i = 0; i < ETH_PACKETS_BATCH_RECV; i++)
-			free(receive_buffer[i]);
 	free(receive_buffer);
 	free(receive_lengths);
 	printf("ERROR: Out of memory\n");
@@ -190,9 +190,9 @@ static bool hash_algo_supported(const efi_guid_t guid)
  * @db:		Signature database for trusted certificates
  * @dbx		Caller needs to set this to true if he is searching dbx
  *
- * A message digest of image pointed to by @regs is calculated and
- * its hash value is compared to entries in signature database pointed
- * to by @db.
+ * A message digest of image pointed to by @regs is calculated, unless
+ * @regs already holds it, and its hash value is compared to entries in
+ * signature database pointed to by @db.
  *
  * Return:	true if found, false if not
  */
@@ -203,9 +203,9 @@ bool efi_signature_lookup_digest(struct efi_image_regions *regs,
 {
 	struct efi_signature_store *siglist;
 	struct efi_sig_data *sig_data;
-	void *hash = NULL;
+	const u8 *hash = NULL;
 	bool found = false;
-	bool hash_done = false;
+	int len = 0;
 
 	EFI_PRINT("%s: Enter, %p, %p\n", __func__, regs, db);
 
@@ -213,8 +213,6 @@ bool efi_signature_lookup_digest(struct efi_image_regions *regs,
 		goto out;
 
 	for (siglist = db; siglist; siglist = siglist->next) {
-		int len = 0;
-		const char *hash_algo = NULL;
 		/*
 		 * if the hash algorithm is unsupported and we get an entry in
 		 * dbx reject the image
@@ -230,18 +228,16 @@ bool efi_signature_lookup_digest(struct efi_image_regions *regs,
 		if (guidcmp(&siglist->sig_type, &efi_guid_sha256))
 			continue;
 
-		hash_algo = guid_to_sha_str(&efi_guid_sha256);
-		/*
-		 * We could check size and hash_algo but efi_hash_regions()
-		 * will do that for us
-		 */
-		if (!hash_done &&
-		    !efi_hash_regions(regs->reg, regs->num, &hash, hash_algo,
-				      &len)) {
-			EFI_PRINT("Digesting an image failed\n");
-			break;
+		/* The digest is computed once and kept in @regs */
+		if (!hash) {
+			hash = efi_image_digest(regs,
+						guid_to_sha_str(&efi_guid_sha256),
+						&len);
+			if (!hash) {
+				EFI_PRINT("Digesting an image failed\n");
+				break;
+			}
 		}
-		hash_done = true;
 
 		for (sig_data = siglist->sig_data_list; sig_data;
 		     sig_data = sig_data->next) {
@@ -253,13 +249,9 @@ bool efi_signature_lookup_digest(struct efi_image_regions *regs,
 			if (sig_data->size == len &&
 			    !memcmp(sig_data->data, hash, len)) {
 				found = true;
-				free(hash);
 				goto out;
 			}
 		}
-
-		free(hash);
-		hash = NULL;
 	}
 
 out:
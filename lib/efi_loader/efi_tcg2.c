@@ -874,43 +874,34 @@ out:
 }
 
 /**
- * tcg2_hash_pe_image() - calculate PE/COFF image hash
+ * tcg2_hash_pe_regions() - calculate PE/COFF image hash from its regions
  *
- * @efi:		pointer to the EFI binary
- * @efi_size:		size of @efi binary
+ * The digests for all active PCR banks are computed in a single pass over
+ * the image. Digests which were already computed for the authentication of
+ * the image are reused.
+ *
+ * @regs:		regions of the image to digest
  * @digest_list:	list of digest algorithms to extend
  *
  * Return:	status code
  */
-static efi_status_t tcg2_hash_pe_image(void *efi, u64 efi_size,
-				       struct tpml_digest_values *digest_list)
+static efi_status_t tcg2_hash_pe_regions(struct efi_image_regions *regs,
+					 struct tpml_digest_values *digest_list)
 {
-	WIN_CERTIFICATE *wincerts = NULL;
-	size_t wincerts_len;
-	struct efi_image_regions *regs = NULL;
-	void *new_efi = NULL;
-	u8 hash[TPM2_SHA512_DIGEST_SIZE];
+	const char *algos[MAX_HASH_COUNT];
+	const u8 *hash;
 	efi_status_t ret;
 	u32 active;
-	int i;
+	int i, count, len;
 
-	new_efi = efi_prepare_aligned_image(efi, &efi_size);
-	if (!new_efi)
-		return EFI_OUT_OF_RESOURCES;
-
-	if (!efi_image_parse(new_efi, efi_size, &regs, &wincerts,
-			     &wincerts_len)) {
-		log_err("Parsing PE executable image failed\n");
-		ret = EFI_UNSUPPORTED;
-		goto out;
-	}
+	if (!regs)
+		return EFI_UNSUPPORTED;
 
 	ret = __get_active_pcr_banks(&active);
-	if (ret != EFI_SUCCESS) {
-		goto out;
-	}
+	if (ret != EFI_SUCCESS)
+		return ret;
 
-	digest_list->count = 0;
+	count = 0;
 	for (i = 0; i < MAX_HASH_COUNT; i++) {
 		u16 hash_alg = hash_algo_list[i].hash_alg;
 
@@ -918,27 +909,74 @@ static efi_status_t tcg2_hash_pe_image(void *efi, u64 efi_size,
 			continue;
 		switch (hash_alg) {
 		case TPM2_ALG_SHA1:
-			hash_calculate("sha1", regs->reg, regs->num, hash);
+			algos[count++] = "sha1";
 			break;
 		case TPM2_ALG_SHA256:
-			hash_calculate("sha256", regs->reg, regs->num, hash);
+			algos[count++] = "sha256";
 			break;
 		case TPM2_ALG_SHA384:
-			hash_calculate("sha384", regs->reg, regs->num, hash);
+			algos[count++] = "sha384";
 			break;
 		case TPM2_ALG_SHA512:
-			hash_calculate("sha512", regs->reg, regs->num, hash);
+			algos[count++] = "sha512";
 			break;
 		default:
 			EFI_PRINT("Unsupported algorithm %x\n", hash_alg);
 			return EFI_INVALID_PARAMETER;
 		}
+	}
+	if (efi_image_hash(regs, algos, count))
+		return EFI_OUT_OF_RESOURCES;
+
+	digest_list->count = 0;
+	for (i = 0; i < MAX_HASH_COUNT; i++) {
+		u16 hash_alg = hash_algo_list[i].hash_alg;
+
+		if (!(active & alg_to_mask(hash_alg)))
+			continue;
+		hash = efi_image_digest(regs, algos[digest_list->count], &len);
+		if (!hash || len != alg_to_len(hash_alg))
+			return EFI_INVALID_PARAMETER;
 		digest_list->digests[digest_list->count].hash_alg = hash_alg;
 		memcpy(&digest_list->digests[digest_list->count].digest, hash,
-		       (u32)alg_to_len(hash_alg));
+		       len);
 		digest_list->count++;
 	}
 
+	return EFI_SUCCESS;
+}
+
+/**
+ * tcg2_hash_pe_image() - calculate PE/COFF image hash
+ *
+ * @efi:		pointer to the EFI binary
+ * @efi_size:		size of @efi binary
+ * @digest_list:	list of digest algorithms to extend
+ *
+ * Return:	status code
+ */
+static efi_status_t tcg2_hash_pe_image(void *efi, u64 efi_size,
+				       struct tpml_digest_values *digest_list)
+{
+	WIN_CERTIFICATE *wincerts = NULL;
+	size_t wincerts_len;
+	struct efi_image_regions *regs = NULL;
+	void *new_efi = NULL;
+	efi_status_t ret;
+
+	new_efi = efi_prepare_aligned_image(efi, &efi_size);
+	if (!new_efi)
+		return EFI_OUT_OF_RESOURCES;
+
+	if (!efi_image_parse(new_efi, efi_size, &regs, &wincerts,
+			     &wincerts_len)) {
+		log_err("Parsing PE executable image failed\n");
+		ret = EFI_UNSUPPORTED;
+		goto out;
+	}
+
+	ret = tcg2_hash_pe_regions(regs, digest_list);
+
 out:
 	if (new_efi != efi)
 		free(new_efi);
@@ -952,12 +990,14 @@ out:
  *
  * @efi:		pointer to the EFI binary
  * @efi_size:		size of @efi binary
+ * @regs:		regions of @efi to digest, see efi_image_parse()
  * @handle:		loaded image handle
  * @loaded_image:	loaded image protocol
  *
  * Return:	status code
  */
 efi_status_t tcg2_measure_pe_image(void *efi, u64 efi_size,
+				   struct efi_image_regions *regs,
 				   struct efi_loaded_image_obj *handle,
 				   struct efi_loaded_image *loaded_image)
 {
@@ -996,7 +1036,7 @@ efi_status_t tcg2_measure_pe_image(void *efi, u64 efi_size,
 		return EFI_UNSUPPORTED;
 	}
 
-	ret = tcg2_hash_pe_image(efi, efi_size, &digest_list);
+	ret = tcg2_hash_pe_regions(regs, &digest_list);
 	if (ret != EFI_SUCCESS)
 		return ret;
 
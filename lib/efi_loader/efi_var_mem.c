@@ -8,8 +8,15 @@
 #include <common.h>
 #include <efi_loader.h>
 #include <efi_variable.h>
+#include <linux/log2.h>
 #include <u-boot/crc.h>
 
+/*
+ * Number of slots in the hash index of the variables. Each variable takes at
+ * least 40 bytes, so the index is never more than 80% full.
+ */
+#define EFI_VAR_INDEX_SLOTS	roundup_pow_of_two(EFI_VAR_BUF_SIZE / 32)
+
 /*
  * The variables efi_var_file and efi_var_entry must be static to avoid
  * referencing them via the global offset table (section .got). The GOT
@@ -17,7 +24,13 @@
  * relocation during SetVirtualAddressMap().
  */
 static struct efi_var_file __efi_runtime_data *efi_var_buf;
-static struct efi_var_entry __efi_runtime_data *efi_current_var;
+
+/*
+ * Open-addressing hash index over GUID and name. Each used slot holds the
+ * offset of a variable in efi_var_buf, so that the index stays valid when
+ * the buffer is mapped to another virtual address. 0 marks a free slot.
+ */
+static u32 __efi_runtime_data *efi_var_index;
 
 /**
  * efi_var_mem_compare() - compare GUID and name with a variable
@@ -56,17 +69,83 @@ efi_var_mem_compare(struct efi_var_entry *var, const efi_guid_t *guid,
 		*next = (struct efi_var_entry *)
 			ALIGN((uintptr_t)data + var->length, 8);
 
-	if (match)
-		efi_current_var = var;
-
 	return match;
 }
 
+/**
+ * efi_var_mem_hash() - hash GUID and name of a variable
+ *
+ * @guid:	GUID of the variable
+ * @name:	name of the variable
+ * Return:	hash value (FNV-1a)
+ */
+static u32 __efi_runtime efi_var_mem_hash(const efi_guid_t *guid,
+					  const u16 *name)
+{
+	const u8 *p = (const u8 *)guid;
+	u32 hash = 2166136261U;
+	int i;
+
+	for (i = 0; i < sizeof(efi_guid_t); ++i)
+		hash = (hash ^ p[i]) * 16777619U;
+	for (; *name; ++name)
+		hash = (hash ^ *name) * 16777619U;
+
+	return hash;
+}
+
+/**
+ * efi_var_index_add() - add a variable to the hash index
+ *
+ * @var:	variable in efi_var_buf
+ */
+static void __efi_runtime efi_var_index_add(struct efi_var_entry *var)
+{
+	u32 slot = efi_var_mem_hash(&var->guid, var->name);
+	int i;
+
+	for (i = 0; i < EFI_VAR_INDEX_SLOTS; ++i, ++slot) {
+		slot &= EFI_VAR_INDEX_SLOTS - 1;
+		if (!efi_var_index[slot]) {
+			efi_var_index[slot] = (uintptr_t)var -
+					      (uintptr_t)efi_var_buf;
+			return;
+		}
+	}
+}
+
+/**
+ * efi_var_index_rebuild() - rebuild the hash index after variables moved
+ */
+static void __efi_runtime efi_var_index_rebuild(void)
+{
+	struct efi_var_entry *var, *last;
+	u16 *data;
+	int i;
+
+	for (i = 0; i < EFI_VAR_INDEX_SLOTS; ++i)
+		efi_var_index[i] = 0;
+
+	last = (struct efi_var_entry *)
+	       ((uintptr_t)efi_var_buf + efi_var_buf->length);
+	for (var = efi_var_buf->var; var < last;) {
+		efi_var_index_add(var);
+
+		for (data = var->name; *data; ++data)
+			;
+		++data;
+		var = (struct efi_var_entry *)
+		      ALIGN((uintptr_t)data + var->length, 8);
+	}
+}
+
 struct efi_var_entry __efi_runtime
 *efi_var_mem_find(const efi_guid_t *guid, const u16 *name,
 		  struct efi_var_entry **next)
 {
-	struct efi_var_entry *var, *last;
+	struct efi_var_entry *var, *last, *pos;
+	u32 slot;
+	int i;
 
 	last = (struct efi_var_entry *)
 	       ((uintptr_t)efi_var_buf + efi_var_buf->length);
@@ -79,28 +158,19 @@ struct efi_var_entry __efi_runtime
 		}
 		return NULL;
 	}
-	if (efi_current_var &&
-	    efi_var_mem_compare(efi_current_var, guid, name, next)) {
-		if (next && *next >= last)
-			*next = NULL;
-		return efi_current_var;
-	}
 
-	var = efi_var_buf->var;
-	if (var < last) {
-		for (; var;) {
-			struct efi_var_entry *pos;
-			bool match;
-
-			match = efi_var_mem_compare(var, guid, name, &pos);
-			if (pos >= last)
-				pos = NULL;
-			if (match) {
-				if (next)
-					*next = pos;
-				return var;
-			}
-			var = pos;
+	slot = efi_var_mem_hash(guid, name);
+	for (i = 0; i < EFI_VAR_INDEX_SLOTS; ++i, ++slot) {
+		slot &= EFI_VAR_INDEX_SLOTS - 1;
+		if (!efi_var_index[slot])
+			break;
+
+		var = (struct efi_var_entry *)
+		      ((uintptr_t)efi_var_buf + efi_var_index[slot]);
+		if (efi_var_mem_compare(var, guid, name, &pos)) {
+			if (next)
+				*next = pos < last ? pos : NULL;
+			return var;
 		}
 	}
 	if (next)
@@ -108,18 +178,18 @@ struct efi_var_entry __efi_runtime
 	return NULL;
 }
 
-void __efi_runtime efi_var_mem_del(struct efi_var_entry *var)
+/**
+ * efi_var_mem_remove() - remove a variable without updating the hash index
+ *
+ * @var:	variable to remove
+ */
+static void __efi_runtime efi_var_mem_remove(struct efi_var_entry *var)
 {
 	u16 *data;
 	struct efi_var_entry *next, *last;
 
-	if (!var)
-		return;
-
 	last = (struct efi_var_entry *)
 	       ((uintptr_t)efi_var_buf + efi_var_buf->length);
-	if (var <= efi_current_var)
-		efi_current_var = NULL;
 
 	for (data = var->name; *data; ++data)
 		;
@@ -135,6 +205,16 @@ void __efi_runtime efi_var_mem_del(struct efi_var_entry *var)
 				   sizeof(struct efi_var_file));
 }
 
+void __efi_runtime efi_var_mem_del(struct efi_var_entry *var)
+{
+	if (!var)
+		return;
+
+	/* The following variables moved, so their offsets changed */
+	efi_var_mem_remove(var);
+	efi_var_index_rebuild();
+}
+
 efi_status_t __efi_runtime efi_var_mem_ins(
 				const u16 *variable_name,
 				const efi_guid_t *vendor, u32 attributes,
@@ -164,6 +244,7 @@ efi_status_t __efi_runtime efi_var_mem_ins(
 			   sizeof(u16) * var_name_len);
 	efi_memcpy_runtime(data, data1, size1);
 	efi_memcpy_runtime((u8 *)data + size1, data2, size2);
+	efi_var_index_add(var);
 
 	var = (struct efi_var_entry *)
 	      ALIGN((uintptr_t)data + var->length, 8);
@@ -206,9 +287,10 @@ static void efi_var_mem_bs_del(void)
 			      ALIGN((uintptr_t)data + var->length, 8);
 		} else {
 			/* delete variable */
-			efi_var_mem_del(var);
+			efi_var_mem_remove(var);
 		}
 	}
+	efi_var_index_rebuild();
 }
 
 /**
@@ -238,7 +320,7 @@ static void EFIAPI __efi_runtime
 efi_var_mem_notify_virtual_address_map(struct efi_event *event, void *context)
 {
 	efi_convert_pointer(0, (void **)&efi_var_buf);
-	efi_current_var = NULL;
+	efi_convert_pointer(0, (void **)&efi_var_index);
 }
 
 efi_status_t efi_var_mem_init(void)
@@ -260,6 +342,16 @@ efi_status_t efi_var_mem_init(void)
 			      (uintptr_t)efi_var_buf;
 	/* crc32 for 0 bytes = 0 */
 
+	ret = efi_allocate_pages(EFI_ALLOCATE_ANY_PAGES,
+				 EFI_RUNTIME_SERVICES_DATA,
+				 efi_size_in_pages(EFI_VAR_INDEX_SLOTS *
+						   sizeof(u32)),
+				 &memory);
+	if (ret != EFI_SUCCESS)
+		return ret;
+	efi_var_index = (u32 *)(uintptr_t)memory;
+	memset(efi_var_index, 0, EFI_VAR_INDEX_SLOTS * sizeof(u32));
+
 	ret = efi_create_event(EVT_SIGNAL_EXIT_BOOT_SERVICES, TPL_CALLBACK,
 			       efi_var_mem_notify_exit_boot_services, NULL,
 			       NULL, &event);
@@ -350,4 +442,5 @@ efi_get_next_variable_name_mem(efi_uintn_t *variable_name_size,
 void efi_var_buf_update(struct efi_var_file *var_buf)
 {
 	memcpy(efi_var_buf, var_buf, EFI_VAR_BUF_SIZE);
+	efi_var_index_rebuild();
 }
@@ -291,6 +291,68 @@ static efi_uintn_t dp_size(struct efi_device_path *dp)
 	return (char *)pos - (char *)dp;
 }
 
+/*
+ * Read several blocks at once and compare them to single block reads.
+ *
+ * With CONFIG_EFI_LOADER_BOUNCE_BUFFER a transfer may be split between the
+ * buffer itself and the bounce buffer, the result must be the same.
+ *
+ * @block_io	block IO protocol of the partition
+ * Return:	EFI_ST_SUCCESS for success
+ */
+static int read_blocks_split(struct efi_block_io *block_io)
+{
+	const efi_uintn_t count = 16;
+	u32 blksz = block_io->media->block_size;
+	efi_physical_addr_t addr;
+	efi_status_t ret;
+	efi_uintn_t i;
+	u8 *blocks;
+	int res = EFI_ST_FAILURE;
+
+	ret = boottime->allocate_pages(EFI_ALLOCATE_ANY_PAGES, EFI_LOADER_DATA,
+				       efi_size_in_pages((count + 1) * blksz),
+				       &addr);
+	if (ret != EFI_SUCCESS) {
+		efi_st_error("AllocatePages failed\n");
+		return EFI_ST_FAILURE;
+	}
+	blocks = (u8 *)(uintptr_t)addr;
+
+	ret = block_io->read_blocks(block_io, block_io->media->media_id, 1,
+				    count * blksz, blocks);
+	if (ret != EFI_SUCCESS) {
+		efi_st_error("ReadBlocks failed\n");
+		goto out;
+	}
+	for (i = 0; i < count; i++) {
+		ret = block_io->read_blocks(block_io, block_io->media->media_id,
+					    1 + i, blksz, blocks + count * blksz);
+		if (ret != EFI_SUCCESS) {
+			efi_st_error("ReadBlocks failed\n");
+			goto out;
+		}
+		if (memcmp(blocks + i * blksz, blocks + count * blksz,
+			   blksz)) {
+			efi_st_error("Block %u differs\n", (unsigned int)i);
+			goto out;
+		}
+	}
+
+	/* Only whole blocks can be transferred */
+	ret = block_io->read_blocks(block_io, block_io->media->media_id, 1,
+				    blksz + 1, blocks);
+	if (ret != EFI_BAD_BUFFER_SIZE) {
+		efi_st_error("ReadBlocks accepted a partial block\n");
+		goto out;
+	}
+	res = EFI_ST_SUCCESS;
+out:
+	boottime->free_pages(addr, efi_size_in_pages((count + 1) * blksz));
+
+	return res;
+}
+
 /*
  * Execute unit test.
  *
@@ -476,6 +538,10 @@ static int execute(void)
 		return EFI_ST_FAILURE;
 	}
 
+	/* A transfer of several blocks matches reading them one by one */
+	if (read_blocks_split(block_io_protocol) != EFI_ST_SUCCESS)
+		return EFI_ST_FAILURE;
+
 #ifdef CONFIG_FAT_WRITE
 	/* Write file */
 	ret = root->open(root, &file, u"u-boot.txt", EFI_FILE_MODE_READ |
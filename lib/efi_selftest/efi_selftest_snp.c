@@ -8,7 +8,7 @@
  * the CopyMem and SetMem boottime services.
  *
  * A DHCP discover message is sent. The test is successful if a
- * DHCP reply is received.
+ * DHCP reply is received and the statistics account for both packets.
  *
  * TODO: Once ConnectController and DisconnectController are implemented
  *	 we should connect our code as controller.
@@ -276,6 +276,51 @@ static int setup(const efi_handle_t handle,
 	return EFI_ST_SUCCESS;
 }
 
+/*
+ * Check the statistics of the network interface.
+ *
+ * At least the DHCP discover message has been sent and the reply has been
+ * received.
+ *
+ * Return:	EFI_ST_SUCCESS for success
+ */
+static int check_statistics(void)
+{
+	struct efi_network_statistics stats;
+	efi_status_t ret;
+	ulong size;
+
+	size = 0;
+	ret = net->statistics(net, 0, &size, &stats);
+	if (ret != EFI_BUFFER_TOO_SMALL || size != sizeof(stats)) {
+		efi_st_error("Statistics did not return the table size\n");
+		return EFI_ST_FAILURE;
+	}
+	ret = net->statistics(net, 1, &size, &stats);
+	if (ret != EFI_SUCCESS) {
+		efi_st_error("Statistics failed\n");
+		return EFI_ST_FAILURE;
+	}
+	if (!stats.tx_total_frames || !stats.tx_broadcast_frames ||
+	    !stats.rx_total_frames || !stats.rx_good_frames ||
+	    stats.rx_total_bytes < sizeof(struct dhcp_hdr)) {
+		efi_st_error("Wrong statistics\n");
+		return EFI_ST_FAILURE;
+	}
+	efi_st_printf("%u packets received, %u dropped\n",
+		      (unsigned int)stats.rx_total_frames,
+		      (unsigned int)stats.rx_dropped_frames);
+
+	/* The statistics have been reset */
+	ret = net->statistics(net, 0, &size, &stats);
+	if (ret != EFI_SUCCESS || stats.tx_total_frames) {
+		efi_st_error("Statistics were not reset\n");
+		return EFI_ST_FAILURE;
+	}
+
+	return EFI_ST_SUCCESS;
+}
+
 /*
  * Execute unit test.
  *
@@ -413,7 +458,7 @@ received:
 	else
 		efi_st_printf("as unicast message.\n");
 
-	return EFI_ST_SUCCESS;
+	return check_statistics();
 }
 
 /*
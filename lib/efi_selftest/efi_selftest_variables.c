@@ -6,12 +6,16 @@
  *
  * This unit test checks the runtime services for variables:
  * GetVariable, GetNextVariableName, SetVariable, QueryVariableInfo.
+ *
+ * The variables_many unit test stores many variables and measures how many
+ * GetVariable calls can be made in a fixed time.
  */
 
 #include <efi_selftest.h>
 
 #define EFI_ST_MAX_DATA_SIZE 16
 #define EFI_ST_MAX_VARNAME_SIZE 80
+#define EFI_ST_MANY_VARS 128
 
 static struct efi_boot_services *boottime;
 static struct efi_runtime_services *runtime;
@@ -245,3 +249,169 @@ EFI_UNIT_TEST(variables) = {
 	.setup = setup,
 	.execute = execute,
 };
+
+static const u16 many_prefix[] = u"efi_m";
+
+/*
+ * Build the name of variable @i of the variables_many test.
+ *
+ * @name	buffer for the name, at least 9 characters
+ * @i		number of the variable
+ */
+static void many_var_name(u16 *name, unsigned int i)
+{
+	memcpy(name, many_prefix, sizeof(many_prefix));
+	name[5] = '0' + i / 100 % 10;
+	name[6] = '0' + i / 10 % 10;
+	name[7] = '0' + i % 10;
+	name[8] = 0;
+}
+
+/*
+ * Check which of the variables of the variables_many test exist.
+ *
+ * @step	only every @step-th variable is expected to exist
+ * Return:	EFI_ST_SUCCESS for success
+ */
+static int many_check(unsigned int step)
+{
+	u16 varname[EFI_ST_MAX_VARNAME_SIZE];
+	unsigned int i, count;
+	efi_status_t ret;
+	efi_uintn_t len;
+	efi_guid_t guid;
+	u32 data;
+
+	for (i = 0; i < EFI_ST_MANY_VARS; i++) {
+		many_var_name(varname, i);
+		len = sizeof(data);
+		ret = runtime->get_variable(varname, &guid_vendor1, NULL,
+					    &len, &data);
+		if (i % step) {
+			if (ret != EFI_NOT_FOUND) {
+				efi_st_error("Deleted variable found\n");
+				return EFI_ST_FAILURE;
+			}
+			continue;
+		}
+		if (ret != EFI_SUCCESS || len != sizeof(data) || data != i) {
+			efi_st_error("GetVariable failed\n");
+			return EFI_ST_FAILURE;
+		}
+	}
+
+	/* Each of the variables is enumerated exactly once */
+	count = 0;
+	*varname = 0;
+	for (;;) {
+		len = sizeof(varname);
+		ret = runtime->get_next_variable_name(&len, varname, &guid);
+		if (ret == EFI_NOT_FOUND)
+			break;
+		if (ret != EFI_SUCCESS) {
+			efi_st_error("GetNextVariableName failed (%u)\n",
+				     (unsigned int)ret);
+			return EFI_ST_FAILURE;
+		}
+		if (!memcmp(&guid, &guid_vendor1, sizeof(guid)) &&
+		    !memcmp(varname, many_prefix, sizeof(many_prefix) - 2))
+			++count;
+	}
+	if (count != (EFI_ST_MANY_VARS + step - 1) / step) {
+		efi_st_error("GetNextVariableName found %u variables\n",
+			     count);
+		return EFI_ST_FAILURE;
+	}
+
+	return EFI_ST_SUCCESS;
+}
+
+/*
+ * Execute the variables_many unit test.
+ */
+static int execute_many(void)
+{
+	u16 varname[EFI_ST_MAX_VARNAME_SIZE];
+	unsigned int i, lookups;
+	struct efi_event *event;
+	efi_status_t ret;
+	efi_uintn_t len;
+	u32 data;
+
+	for (i = 0; i < EFI_ST_MANY_VARS; i++) {
+		many_var_name(varname, i);
+		data = i;
+		ret = runtime->set_variable(varname, &guid_vendor1,
+					    EFI_VARIABLE_BOOTSERVICE_ACCESS,
+					    sizeof(data), &data);
+		if (ret != EFI_SUCCESS) {
+			efi_st_error("SetVariable failed\n");
+			return EFI_ST_FAILURE;
+		}
+	}
+	if (many_check(1) != EFI_ST_SUCCESS)
+		return EFI_ST_FAILURE;
+
+	/* Delete every other variable */
+	for (i = 1; i < EFI_ST_MANY_VARS; i += 2) {
+		many_var_name(varname, i);
+		ret = runtime->set_variable(varname, &guid_vendor1, 0, 0, NULL);
+		if (ret != EFI_SUCCESS) {
+			efi_st_error("SetVariable failed\n");
+			return EFI_ST_FAILURE;
+		}
+	}
+	if (many_check(2) != EFI_ST_SUCCESS)
+		return EFI_ST_FAILURE;
+
+	/* Count the lookups made in 100 ms */
+	ret = boottime->create_event(EVT_TIMER, TPL_CALLBACK, NULL, NULL,
+				     &event);
+	if (ret != EFI_SUCCESS) {
+		efi_st_error("could not create event\n");
+		return EFI_ST_FAILURE;
+	}
+	ret = boottime->set_timer(event, EFI_TIMER_RELATIVE, 1000000);
+	if (ret != EFI_SUCCESS) {
+		efi_st_error("Could not set timer\n");
+		return EFI_ST_FAILURE;
+	}
+	lookups = 0;
+	while (boottime->check_event(event) == EFI_NOT_READY) {
+		for (i = 0; i < EFI_ST_MANY_VARS; i += 2, ++lookups) {
+			many_var_name(varname, i);
+			len = sizeof(data);
+			ret = runtime->get_variable(varname, &guid_vendor1,
+						    NULL, &len, &data);
+			if (ret != EFI_SUCCESS) {
+				efi_st_error("GetVariable failed\n");
+				return EFI_ST_FAILURE;
+			}
+		}
+	}
+	ret = boottime->close_event(event);
+	if (ret != EFI_SUCCESS) {
+		efi_st_error("could not close event\n");
+		return EFI_ST_FAILURE;
+	}
+	efi_st_printf("%u lookups of %u variables in 100 ms\n", lookups,
+		      EFI_ST_MANY_VARS / 2);
+
+	for (i = 0; i < EFI_ST_MANY_VARS; i += 2) {
+		many_var_name(varname, i);
+		ret = runtime->set_variable(varname, &guid_vendor1, 0, 0, NULL);
+		if (ret != EFI_SUCCESS) {
+			efi_st_error("SetVariable failed\n");
+			return EFI_ST_FAILURE;
+		}
+	}
+
+	return EFI_ST_SUCCESS;
+}
+
+EFI_UNIT_TEST(variables_many) = {
+	.name = "variables many",
+	.phase = EFI_EXECUTE_BEFORE_BOOTTIME_EXIT,
+	.setup = setup,
+	.execute = execute_many,
+};
@@ -72,14 +72,48 @@ int gzip_parse_header(const unsigned char *src, unsigned long len)
 	return i;
 }
 
+static int zunzip_used(void *dst, int dstlen, unsigned char *src,
+		       unsigned long *lenp, int stoponerr, int offset,
+		       unsigned long *usedp);
+
+/*
+ * A gzip file may hold several members back to back (e.g. the output of pigz
+ * or of concatenating .gz files), each with its own header and an 8-byte
+ * CRC32/ISIZE trailer. The uncompressed result is the concatenation of all
+ * members. Anything after the last member which does not look like a gzip
+ * header is ignored, as before.
+ */
 int gunzip(void *dst, int dstlen, unsigned char *src, unsigned long *lenp)
 {
-	int offset = gzip_parse_header(src, *lenp);
+	unsigned long len = *lenp, total = 0;
+	int offset, ret;
 
+	offset = gzip_parse_header(src, len);
 	if (offset < 0)
 		return offset;
 
-	return zunzip(dst, dstlen, src, lenp, 1, offset);
+	for (;;) {
+		unsigned long out = len, used;
+
+		ret = zunzip_used(dst + total, dstlen - total, src, &out, 1,
+				  offset, &used);
+		total += out;
+		if (ret)
+			break;
+
+		/* Skip the trailer and look for another member */
+		src += offset + used + 8;
+		if (offset + used + 8 + 10 > len || src[0] != (uchar)HEADER0 ||
+		    src[1] != (uchar)HEADER1 || src[2] != DEFLATED)
+			break;
+		len -= offset + used + 8;
+		offset = gzip_parse_header(src, len);
+		if (offset < 0)
+			break;
+	}
+	*lenp = total;
+
+	return ret;
 }
 
 #ifdef CONFIG_CMD_UNZIP
@@ -275,8 +309,9 @@ out:
 /*
  * Uncompress blocks compressed with zlib without headers
  */
-int zunzip(void *dst, int dstlen, unsigned char *src, unsigned long *lenp,
-						int stoponerr, int offset)
+static int zunzip_used(void *dst, int dstlen, unsigned char *src,
+		       unsigned long *lenp, int stoponerr, int offset,
+		       unsigned long *usedp)
 {
 	z_stream s;
 	int err = 0;
@@ -304,7 +339,16 @@ int zunzip(void *dst, int dstlen, unsigned char *src, unsigned long *lenp,
 		}
 	} while (r == Z_BUF_ERROR);
 	*lenp = s.next_out - (unsigned char *) dst;
+	*usedp = s.next_in - (src + offset);
 	inflateEnd(&s);
 
 	return err;
 }
+
+int zunzip(void *dst, int dstlen, unsigned char *src, unsigned long *lenp,
+						int stoponerr, int offset)
+{
+	unsigned long used;
+
+	return zunzip_used(dst, dstlen, src, lenp, stoponerr, offset, &used);
+}
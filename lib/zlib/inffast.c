@@ -12,6 +12,50 @@
 
 #ifndef ASMINF
 
+/*
+   Copy a match of len bytes from dist bytes back in the output and return
+   the new output pointer.  The copy is done in the largest chunks (up to a
+   machine word) that do not exceed dist: every chunk then only reads bytes
+   already written, so overlapping matches replicate correctly.  A distance
+   of one is a run of a single byte.  Nothing is written past out + len.
+ */
+local inline unsigned char FAR *chunk_copy(unsigned char FAR *out,
+                                           unsigned dist, unsigned len)
+{
+    unsigned char FAR *from = out - dist;
+
+    if (dist == 1) {
+        memset(out, *from, len);
+        return out + len;
+    }
+    if (dist >= sizeof(unsigned long)) {
+        while (len >= sizeof(unsigned long)) {
+            put_unaligned(get_unaligned((unsigned long *)from),
+                          (unsigned long *)out);
+            out += sizeof(unsigned long);
+            from += sizeof(unsigned long);
+            len -= sizeof(unsigned long);
+        }
+    } else if (dist >= 4) {
+        while (len >= 4) {
+            put_unaligned(get_unaligned((u32 *)from), (u32 *)out);
+            out += 4;
+            from += 4;
+            len -= 4;
+        }
+    } else {
+        while (len >= 2) {
+            put_unaligned(get_unaligned((u16 *)from), (u16 *)out);
+            out += 2;
+            from += 2;
+            len -= 2;
+        }
+    }
+    while (len--)
+        *out++ = *from++;
+    return out;
+}
+
 /*
    Decode literal, length, and distance codes and write out the resulting
    literal and match bytes until either not enough input or output is
@@ -109,10 +153,23 @@ void inflate_fast(z_streamp strm, unsigned start)
        input data or output space */
     do {
         if (bits < 15) {
-	    hold += (unsigned long)(*in++) << bits;
-            bits += 8;
-	    hold += (unsigned long)(*in++) << bits;
-            bits += 8;
+            /*
+             * With a 64-bit accumulator, load enough bytes for a complete
+             * length/distance pair (48 bits) so that none of the refills
+             * below are taken in this pass.  This reads at most six bytes,
+             * within the guaranteed strm->avail_in >= 6.
+             */
+            if (sizeof(hold) > 4) {
+                do {
+                    hold += (unsigned long)(*in++) << bits;
+                    bits += 8;
+                } while (bits < 48);
+            } else {
+		hold += (unsigned long)(*in++) << bits;
+                bits += 8;
+		hold += (unsigned long)(*in++) << bits;
+                bits += 8;
+            }
         }
         this = lcode[hold & lmask];
       dolen:
@@ -234,47 +291,7 @@ void inflate_fast(z_streamp strm, unsigned start)
                     }
                 }
                 else {
-		    unsigned short *sout;
-		    unsigned long loops;
-
-                    from = out - dist;          /* copy direct from output */
-                    /* minimum length is three */
-		    /* Align out addr */
-		    if (!((long)(out - 1) & 1)) {
-			*out++ = *from++;
-			len--;
-		    }
-		    sout = (unsigned short *)(out);
-		    if (dist > 2 ) {
-			unsigned short *sfrom;
-
-			sfrom = (unsigned short *)(from);
-			loops = len >> 1;
-			do
-			    *sout++ = get_unaligned(++sfrom);
-			while (--loops);
-			out = (unsigned char *)sout;
-			from = (unsigned char *)sfrom;
-		    } else { /* dist == 1 or dist == 2 */
-			unsigned short pat16;
-
-			pat16 = *(sout-2);
-			if (dist == 1)
-#if defined(__BIG_ENDIAN)
-			    pat16 = (pat16 & 0xff) | ((pat16 & 0xff ) << 8);
-#elif defined(__LITTLE_ENDIAN)
-			    pat16 = (pat16 & 0xff00) | ((pat16 & 0xff00 ) >> 8);
-#else
-#error __BIG_ENDIAN nor __LITTLE_ENDIAN is defined
-#endif
-			loops = len >> 1;
-			do
-			    *sout++ = pat16;
-			while (--loops);
-			out = (unsigned char *)sout;
-		    }
-		    if (len & 1)
-			*out++ = *from++;
+                    out = chunk_copy(out, dist, len);
                 }
             }
             else if ((op & 64) == 0) {          /* 2nd level distance code */
@@ -0,0 +1,157 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for the hush parse-tree cache
+ */
+
+#include <common.h>
+#include <cli_hush.h>
+#include <command.h>
+#include <env.h>
+#include <time.h>
+#include <asm/global_data.h>
+#include <test/lib.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+/* Only the shared part of the distro scripts is needed */
+#define BOOT_TARGET_DEVICES(func)
+#include <config_distro_bootcmd.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+struct test_data {
+	char *cmd;
+	char *expected;
+};
+
+static struct test_data cache_data[] = {
+	{"setenv hcA 1; echo ${hcA}; setenv hcA",
+	 "1"},
+	{"for hcI in 1 2 3; do echo -n \"${hcI}, \"; done; echo",
+	 "1, 2, 3, "},
+	{"hcV=x; if test ${hcV} = x; then echo yes; else echo no; fi",
+	 "yes"},
+	{"setenv hcS 'echo -n one; echo'; run hcS; setenv hcS",
+	 "one"},
+	{"setenv hcS 'echo -n $hcI'; hcI=7; run hcS; echo; setenv hcS",
+	 "7"},
+};
+
+static int hush_cache_run_one(struct unit_test_state *uts, const char *cmd,
+			      const char *expected)
+{
+	ut_silence_console(uts);
+	console_record_reset_enable();
+	ut_assertok(run_command(cmd, 0));
+	ut_unsilence_console(uts);
+	console_record_readline(uts->actual_str, sizeof(uts->actual_str));
+	ut_asserteq_str(expected, uts->actual_str);
+	ut_assertok(ut_check_console_end(uts));
+
+	return 0;
+}
+
+/* A cached script must behave exactly like a freshly parsed one */
+static int lib_test_hush_cache(struct unit_test_state *uts)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(cache_data); ++i) {
+		hush_cache_enable(false);
+		ut_assertok(hush_cache_run_one(uts, cache_data[i].cmd,
+					       cache_data[i].expected));
+		hush_cache_enable(true);
+		/* The first run fills the cache, the second one uses it */
+		ut_assertok(hush_cache_run_one(uts, cache_data[i].cmd,
+					       cache_data[i].expected));
+		ut_assertok(hush_cache_run_one(uts, cache_data[i].cmd,
+					       cache_data[i].expected));
+	}
+
+	/* Changing a variable must not run its old contents */
+	ut_assertok(env_set("hcS", "echo one"));
+	ut_assertok(hush_cache_run_one(uts, "run hcS", "one"));
+	ut_assertok(env_set("hcS", "echo two"));
+	ut_assertok(hush_cache_run_one(uts, "run hcS", "two"));
+	ut_assertok(env_set("hcS", NULL));
+
+	return 0;
+}
+LIB_TEST(lib_test_hush_cache, 0);
+
+/* Leaving a for loop early must not corrupt the cached loop */
+static int lib_test_hush_cache_exit(struct unit_test_state *uts)
+{
+	hush_cache_enable(true);
+	ut_assertok(env_set("hcR", NULL));
+	ut_assertok(env_set("hcX",
+			    "for hcI in a b c; do setenv hcR ${hcR}${hcI}; "
+			    "if test ${hcI} = b; then exit; fi; done"));
+	ut_assertok(run_command("run hcX", 0));
+	ut_assertok(run_command("run hcX", 0));
+	ut_asserteq_str("abab", env_get("hcR"));
+	ut_assertok(env_set("hcX", NULL));
+	ut_assertok(env_set("hcR", NULL));
+
+	return 0;
+}
+LIB_TEST(lib_test_hush_cache_exit, 0);
+
+static const char distro_env[] = BOOTENV;
+
+static void hush_cache_distro_env(bool set)
+{
+	const char *p;
+	char buf[64];
+
+	for (p = distro_env; *p; p += strlen(p) + 1) {
+		const char *eq = strchr(p, '=');
+
+		if (!eq || eq - p >= sizeof(buf))
+			continue;
+		memcpy(buf, p, eq - p);
+		buf[eq - p] = '\0';
+		env_set(buf, set ? eq + 1 : NULL);
+	}
+}
+
+static ulong hush_cache_time_scan(int count)
+{
+	ulong start;
+	int i;
+
+	start = timer_get_us();
+	for (i = 0; i < count; i++)
+		run_command("run scan_dev_for_boot", 0);
+
+	return timer_get_us() - start;
+}
+
+/* Compare the cost of the distro scan scripts with and without the cache */
+static int lib_test_hush_cache_distro(struct unit_test_state *uts)
+{
+	const int count = 100;
+	ulong off, on;
+
+	hush_cache_distro_env(true);
+	ut_assertok(env_set("devtype", "host"));
+	ut_assertok(env_set("devnum", "0"));
+	ut_assertok(env_set("distro_bootpart", "1"));
+
+	ut_silence_console(uts);
+	hush_cache_enable(false);
+	off = hush_cache_time_scan(count);
+	hush_cache_enable(true);
+	on = hush_cache_time_scan(count);
+	ut_unsilence_console(uts);
+	printf("%d distro scans: %lu us uncached, %lu us cached\n", count,
+	       off, on);
+
+	ut_assertok(env_set("distro_bootpart", NULL));
+	ut_assertok(env_set("devnum", NULL));
+	ut_assertok(env_set("devtype", NULL));
+	hush_cache_distro_env(false);
+
+	return 0;
+}
+LIB_TEST(lib_test_hush_cache_distro, 0);
@@ -33,3 +33,98 @@ static int dm_test_cyclic_running(struct unit_test_state *uts)
 	return 0;
 }
 COMMON_TEST(dm_test_cyclic_running, 0);
+
+static int cyclic_count;
+
+static void cyclic_test_count(void *ctx)
+{
+	cyclic_count++;
+}
+
+/* Test that a new function runs even if nothing else is due */
+static int dm_test_cyclic_due(struct unit_test_state *uts)
+{
+	struct cyclic_info *slow, *fast;
+	int i;
+
+	cyclic_count = 0;
+	slow = cyclic_register(cyclic_test_count, 1000 * 1000 * 1000, "slow",
+			       NULL);
+	ut_assertnonnull(slow);
+	schedule();
+	ut_asserteq(1, cyclic_count);
+	schedule();
+	ut_asserteq(1, cyclic_count);
+
+	fast = cyclic_register(cyclic_test_count, 0, "fast", NULL);
+	ut_assertnonnull(fast);
+	for (i = 0; i < 3; i++)
+		schedule();
+	ut_asserteq(4, cyclic_count);
+	ut_asserteq(1, slow->run_cnt);
+	ut_asserteq(3, fast->run_cnt);
+
+	/* Each run lands in one histogram bucket */
+	for (i = 0; i < CYCLIC_HIST_BUCKETS; i++)
+		cyclic_count -= fast->hist[i];
+	ut_asserteq(1, cyclic_count);
+	ut_assert(fast->max_cpu_time_us <= fast->cpu_time_us);
+
+	ut_assertok(cyclic_unregister(fast));
+	ut_assertok(cyclic_unregister(slow));
+
+	return 0;
+}
+COMMON_TEST(dm_test_cyclic_due, 0);
+
+static int dm_test_cyclic_hist(struct unit_test_state *uts)
+{
+	ut_asserteq(0, cyclic_hist_bucket(0));
+	ut_asserteq(1, cyclic_hist_bucket(1));
+	ut_asserteq(1, cyclic_hist_bucket(3));
+	ut_asserteq(2, cyclic_hist_bucket(4));
+	ut_asserteq(3, cyclic_hist_bucket(63));
+	ut_asserteq(4, cyclic_hist_bucket(64));
+	ut_asserteq(CYCLIC_HIST_BUCKETS - 1, cyclic_hist_bucket(4096));
+	ut_asserteq(CYCLIC_HIST_BUCKETS - 1, cyclic_hist_bucket(U64_MAX));
+
+	return 0;
+}
+COMMON_TEST(dm_test_cyclic_hist, 0);
+
+/* Measure what schedule() costs while no function is due */
+static int dm_test_cyclic_overhead(struct unit_test_state *uts)
+{
+	const int count = 100000;
+	struct cyclic_info *cyclic[8];
+	ulong start, idle, busy;
+	int i;
+
+	ut_assertok(cyclic_unregister_all());
+	start = timer_get_us();
+	for (i = 0; i < count; i++)
+		schedule();
+	idle = timer_get_us() - start;
+
+	cyclic_count = 0;
+	for (i = 0; i < ARRAY_SIZE(cyclic); i++) {
+		cyclic[i] = cyclic_register(cyclic_test_count,
+					    1000 * 1000 * 1000, "idle", NULL);
+		ut_assertnonnull(cyclic[i]);
+	}
+	/* The first call runs them all, later ones find nothing due */
+	start = timer_get_us();
+	for (i = 0; i < count; i++)
+		schedule();
+	busy = timer_get_us() - start;
+	ut_asserteq(ARRAY_SIZE(cyclic), cyclic_count);
+
+	printf("%d schedule() calls: %lu us without, %lu us with %zu functions\n",
+	       count, idle, busy, ARRAY_SIZE(cyclic));
+
+	for (i = 0; i < ARRAY_SIZE(cyclic); i++)
+		ut_assertok(cyclic_unregister(cyclic[i]));
+
+	return 0;
+}
+COMMON_TEST(dm_test_cyclic_overhead, 0);
@@ -12,7 +12,9 @@
 #include <log.h>
 #include <malloc.h>
 #include <mapmem.h>
+#include <time.h>
 #include <asm/io.h>
+#include <linux/sizes.h>
 
 #include <u-boot/lz4.h>
 #include <u-boot/zlib.h>
@@ -508,6 +510,88 @@ static int compression_test_zstd(struct unit_test_state *uts)
 }
 COMPRESSION_TEST(compression_test_zstd, 0);
 
+/**
+ * compression_test_gzip_matches() - Check gunzip() with all match distances
+ *
+ * This builds a buffer of runs which repeat at every distance from 1 to 64
+ * bytes, so that inflate sees both overlapping and non-overlapping matches
+ * for each copy width it uses. The result of gunzip() must match what was
+ * given to gzip(). The decompression throughput is printed too.
+ */
+static int compression_test_gzip_matches(struct unit_test_state *uts)
+{
+	const ulong size = SZ_1M;
+	ulong comp_size = size, unc_size;
+	uchar *orig, *comp, *unc;
+	uint dist, pos, i;
+	ulong start, us;
+
+	orig = malloc(size);
+	comp = malloc(size);
+	unc = malloc(size + 1);
+	ut_assertnonnull(orig);
+	ut_assertnonnull(comp);
+	ut_assertnonnull(unc);
+
+	for (pos = 0, dist = 1; pos < size; dist = dist % 64 + 1) {
+		for (i = 0; i < dist && pos < size; i++, pos++)
+			orig[pos] = (pos * 2654435761U) >> 24;
+		for (i = 0; i < 3 * 258 && pos < size; i++, pos++)
+			orig[pos] = orig[pos - dist];
+	}
+	ut_assertok(gzip(comp, &comp_size, orig, size));
+
+	unc_size = comp_size;
+	unc[size] = 'A';
+	start = timer_get_us();
+	ut_assertok(gunzip(unc, size + 1, comp, &unc_size));
+	us = timer_get_us() - start;
+	ut_asserteq(size, unc_size);
+	ut_asserteq_mem(orig, unc, size);
+	ut_asserteq('A', unc[size]);
+	printf("\tgunzip: %lu bytes in %lu us (%lu MB/s)\n", size, us,
+	       size / max(us, 1UL));
+
+	free(unc);
+	free(comp);
+	free(orig);
+
+	return 0;
+}
+COMPRESSION_TEST(compression_test_gzip_matches, 0);
+
+/* Check that gunzip() handles several gzip members back to back */
+static int compression_test_gzip_multi(struct unit_test_state *uts)
+{
+	const ulong plain_size = strlen(plain);
+	ulong first, second, unc_size;
+	char comp[TEST_BUFFER_SIZE * 2];
+	char unc[TEST_BUFFER_SIZE * 2];
+
+	first = TEST_BUFFER_SIZE;
+	ut_assertok(gzip(comp, &first, (void *)plain, plain_size));
+	second = TEST_BUFFER_SIZE;
+	ut_assertok(gzip(comp + first, &second, (void *)plain, plain_size / 2));
+
+	/* Both members are decompressed, trailing garbage is ignored */
+	memset(comp + first + second, 'A', 16);
+	unc_size = first + second + 16;
+	ut_assertok(gunzip(unc, sizeof(unc), (uchar *)comp, &unc_size));
+	ut_asserteq(plain_size + plain_size / 2, unc_size);
+	ut_asserteq_mem(plain, unc, plain_size);
+	ut_asserteq_mem(plain, unc + plain_size, plain_size / 2);
+
+	/* The second member must not overrun the output buffer */
+	unc_size = first + second;
+	unc[plain_size + plain_size / 2 - 1] = 'A';
+	ut_assert(gunzip(unc, plain_size + plain_size / 2 - 1, (uchar *)comp,
+			 &unc_size));
+	ut_asserteq('A', unc[plain_size + plain_size / 2 - 1]);
+
+	return 0;
+}
+COMPRESSION_TEST(compression_test_gzip_multi, 0);
+
 static int compress_using_none(struct unit_test_state *uts,
 			       void *in, unsigned long in_size,
 			       void *out, unsigned long out_max,
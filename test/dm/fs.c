@@ -0,0 +1,208 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for keeping filesystems mounted between operations
+ *
+ * These use the FAT partition of the mmc1 image created by test_ut.py
+ */
+
+#include <common.h>
+#include <blk.h>
+#include <command.h>
+#include <dm.h>
+#include <fs.h>
+#include <malloc.h>
+#include <mapmem.h>
+#include <part.h>
+#include <sandbox_host.h>
+#include <time.h>
+#include <dm/device-internal.h>
+#include <dm/test.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+#define FS_TEST_FILE	"/extlinux/extlinux.conf"
+#define FS_TEST_ADDR	0x1000000
+
+static int fs_test_read(struct unit_test_state *uts, ulong addr, loff_t *sizep)
+{
+	ut_assertok(fs_set_blk_dev("mmc", "1:1", FS_TYPE_ANY));
+	ut_assertok(fs_read(FS_TEST_FILE, addr, 0, 0, sizep));
+
+	return 0;
+}
+
+/* Files read from a filesystem kept mounted must match a fresh mount */
+static int dm_test_fs_mount_cache(struct unit_test_state *uts)
+{
+	struct udevice *part_dev;
+	struct blk_desc *desc;
+	loff_t size, size2;
+	void *buf, *buf2;
+	ulong hits;
+
+	fs_mount_cache_enable(false);
+	hits = fs_mount_get_hits();
+	ut_assertok(fs_test_read(uts, FS_TEST_ADDR, &size));
+	ut_assert(size > 0);
+	ut_assertok(fs_test_read(uts, FS_TEST_ADDR, &size));
+	ut_asserteq(hits, fs_mount_get_hits());
+
+	/* The first access mounts the filesystem, the second reuses it */
+	fs_mount_cache_enable(true);
+	ut_assertok(fs_test_read(uts, FS_TEST_ADDR + 0x10000, &size2));
+	ut_asserteq(size, size2);
+	ut_asserteq(hits, fs_mount_get_hits());
+	ut_assertok(fs_test_read(uts, FS_TEST_ADDR + 0x20000, &size2));
+	ut_asserteq(size, size2);
+	ut_asserteq(hits + 1, fs_mount_get_hits());
+	buf = map_sysmem(FS_TEST_ADDR, size);
+	buf2 = map_sysmem(FS_TEST_ADDR + 0x20000, size);
+	ut_asserteq_mem(buf, buf2, size);
+	unmap_sysmem(buf2);
+	unmap_sysmem(buf);
+
+	/* The mounted filesystem is only used for the type asked for */
+	ut_asserteq(-1, fs_set_blk_dev("mmc", "1:1", FS_TYPE_EXT));
+	ut_assertok(fs_set_blk_dev("mmc", "1:1", FS_TYPE_FAT));
+	ut_asserteq(FS_TYPE_FAT, fs_get_type());
+	ut_asserteq(1, fs_exists(FS_TEST_FILE));
+	ut_assertok(fs_test_read(uts, FS_TEST_ADDR, &size2));
+	hits = fs_mount_get_hits();
+
+	/*
+	 * Writing through the partition device, as EFI block I/O does, drops
+	 * the mount. Write back the boot sector so the image is unchanged.
+	 */
+	ut_asserteq(1, blk_get_device_by_str("mmc", "1", &desc));
+	ut_assertok(device_find_first_child_by_uclass(desc->bdev,
+						      UCLASS_PARTITION,
+						      &part_dev));
+	buf = malloc(desc->blksz);
+	ut_assertnonnull(buf);
+	ut_asserteq(1, disk_blk_read(part_dev, 0, 1, buf));
+	ut_asserteq(1, disk_blk_write(part_dev, 0, 1, buf));
+	free(buf);
+	ut_assertok(fs_test_read(uts, FS_TEST_ADDR, &size2));
+	ut_asserteq(size, size2);
+	ut_asserteq(hits, fs_mount_get_hits());
+	ut_assertok(fs_test_read(uts, FS_TEST_ADDR, &size2));
+	ut_asserteq(hits + 1, fs_mount_get_hits());
+
+	fs_invalidate(NULL);
+
+	return 0;
+}
+DM_TEST(dm_test_fs_mount_cache, UT_TESTF_SCAN_FDT);
+
+/* A mount is not reused once the medium behind the device may have changed */
+static int dm_test_fs_mount_cache_swap(struct unit_test_state *uts)
+{
+	struct udevice *dev, *blk;
+	struct blk_desc *desc;
+	loff_t size;
+	ulong hits;
+
+	fs_mount_cache_enable(true);
+
+	/* Re-initialising the card drops the mount */
+	ut_assertok(fs_test_read(uts, FS_TEST_ADDR, &size));
+	ut_assertok(fs_test_read(uts, FS_TEST_ADDR, &size));
+	ut_silence_console(uts);
+	ut_assertok(run_command("mmc dev 1", 0));
+	ut_assertok(run_command("mmc rescan", 0));
+	ut_unsilence_console(uts);
+	hits = fs_mount_get_hits();
+	ut_assertok(fs_test_read(uts, FS_TEST_ADDR, &size));
+	ut_asserteq(hits, fs_mount_get_hits());
+
+	/* Swap the image behind a host device, files created in test_ut.py */
+	ut_assertok(host_create_device("fstest", true, &dev));
+	ut_assertok(host_attach_file(dev, "2MB.ext2.img"));
+	ut_assertok(blk_get_from_parent(dev, &blk));
+	ut_assertok(device_probe(blk));
+	desc = dev_get_uclass_plat(blk);
+	ut_assertok(fs_set_blk_dev_with_part(desc, 0));
+	ut_asserteq(FS_TYPE_EXT, fs_get_type());
+	fs_close();
+
+	ut_assertok(host_detach_file(dev));
+	ut_assertok(host_attach_file(dev, "1MB.fat32.img"));
+	ut_assertok(blk_get_from_parent(dev, &blk));
+	ut_assertok(device_probe(blk));
+	desc = dev_get_uclass_plat(blk);
+	hits = fs_mount_get_hits();
+	ut_assertok(fs_set_blk_dev_with_part(desc, 0));
+	ut_asserteq(FS_TYPE_FAT, fs_get_type());
+	ut_asserteq(hits, fs_mount_get_hits());
+	fs_close();
+
+	ut_assertok(host_detach_file(dev));
+	ut_assertok(device_unbind(dev));
+	fs_invalidate(NULL);
+
+	return 0;
+}
+DM_TEST(dm_test_fs_mount_cache_swap, UT_TESTF_SCAN_FDT);
+
+/* Access the file the way the EFI file protocol does */
+static int fs_test_efi_read(struct blk_desc *desc, ulong addr)
+{
+	loff_t size, actread;
+
+	if (fs_set_blk_dev_with_part(desc, 1) || !fs_exists(FS_TEST_FILE))
+		return -ENOENT;
+	if (fs_set_blk_dev_with_part(desc, 1) || fs_size(FS_TEST_FILE, &size))
+		return -EIO;
+	if (fs_set_blk_dev_with_part(desc, 1) ||
+	    fs_read(FS_TEST_FILE, addr, 0, size, &actread))
+		return -EIO;
+
+	return 0;
+}
+
+static ulong fs_test_time(struct blk_desc *desc, int count)
+{
+	char cmd[80];
+	ulong start;
+	int i;
+
+	snprintf(cmd, sizeof(cmd), "load mmc 1:1 %x %s", FS_TEST_ADDR,
+		 FS_TEST_FILE);
+	start = timer_get_us();
+	for (i = 0; i < count; i++) {
+		if (desc ? fs_test_efi_read(desc, FS_TEST_ADDR) :
+		    run_command(cmd, 0))
+			return 0;
+	}
+
+	return timer_get_us() - start;
+}
+
+/* Compare the cost of loading many files with and without the mount cache */
+static int dm_test_fs_mount_cache_time(struct unit_test_state *uts)
+{
+	const int count = 200;
+	ulong load_off, load_on, efi_off, efi_on;
+	struct blk_desc *desc;
+
+	ut_asserteq(1, blk_get_device_by_str("mmc", "1", &desc));
+
+	ut_silence_console(uts);
+	fs_mount_cache_enable(false);
+	load_off = fs_test_time(NULL, count);
+	efi_off = fs_test_time(desc, count);
+	fs_mount_cache_enable(true);
+	load_on = fs_test_time(NULL, count);
+	efi_on = fs_test_time(desc, count);
+	ut_unsilence_console(uts);
+
+	ut_assert(load_off && load_on && efi_off && efi_on);
+	printf("%d loads: %lu us uncached, %lu us cached\n", count, load_off,
+	       load_on);
+	printf("%d EFI-style reads: %lu us uncached, %lu us cached\n", count,
+	       efi_off, efi_on);
+	fs_invalidate(NULL);
+
+	return 0;
+}
+DM_TEST(dm_test_fs_mount_cache_time, UT_TESTF_SCAN_FDT);
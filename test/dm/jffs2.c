@@ -0,0 +1,280 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for building the JFFS2 node lists from erase-block summaries
+ *
+ * The images are built in memory and read as memory-mapped NOR flash.
+ */
+
+#include <common.h>
+#include <console.h>
+#include <malloc.h>
+#include <mapmem.h>
+#include <jffs2/jffs2.h>
+#include <jffs2/load_kernel.h>
+#include <jffs2/jffs2_1pass.h>
+#include <linux/stat.h>
+#include <u-boot/crc.h>
+#include <dm/test.h>
+#include <test/test.h>
+#include <test/ut.h>
+#include "../../fs/jffs2/summary.h"
+
+#define JFFS2_TEST_SECTOR	0x2000
+#define JFFS2_TEST_SECTORS	2
+#define JFFS2_TEST_SIZE		(JFFS2_TEST_SECTOR * JFFS2_TEST_SECTORS)
+#define JFFS2_TEST_TIME		1000000000
+#define JFFS2_TEST_FILE		"second file\n"
+
+/* Summary variants of the test image */
+enum jffs2_test_sum {
+	JFFS2_TEST_NO_SUM,	/* no summary, full scan */
+	JFFS2_TEST_SUM,		/* valid summary in each erase block */
+	JFFS2_TEST_BAD_SUM,	/* summary with a bad CRC, full scan */
+};
+
+/**
+ * struct jffs2_test_img - JFFS2 image being written
+ *
+ * @buf: Image contents
+ * @block: Offset of the erase block being written
+ * @ofs: Offset at which to write the next node
+ * @sum: Summary entries for the erase block being written
+ * @sum_len: Number of bytes used in @sum
+ * @sum_num: Number of entries in @sum
+ */
+struct jffs2_test_img {
+	u8 *buf;
+	u32 block;
+	u32 ofs;
+	u8 sum[256];
+	u32 sum_len;
+	u32 sum_num;
+};
+
+static void jffs2_test_add_inode(struct jffs2_test_img *img, u32 ino,
+				 u32 mode, const char *data)
+{
+	struct jffs2_raw_inode *ri = (void *)img->buf + img->ofs;
+	struct jffs2_sum_inode_flash *si = (void *)img->sum + img->sum_len;
+	u32 len = strlen(data);
+
+	memset(ri, '\0', sizeof(*ri));
+	ri->magic = JFFS2_MAGIC_BITMASK;
+	ri->nodetype = JFFS2_NODETYPE_INODE;
+	ri->totlen = sizeof(*ri) + len;
+	ri->hdr_crc = crc32_no_comp(0, (uchar *)ri,
+				    sizeof(struct jffs2_unknown_node) - 4);
+	ri->ino = ino;
+	ri->version = 1;
+	ri->mode = mode;
+	ri->isize = len;
+	ri->atime = JFFS2_TEST_TIME;
+	ri->mtime = JFFS2_TEST_TIME;
+	ri->ctime = JFFS2_TEST_TIME;
+	ri->csize = len;
+	ri->dsize = len;
+	ri->compr = JFFS2_COMPR_NONE;
+	ri->data_crc = crc32_no_comp(0, (uchar *)data, len);
+	ri->node_crc = crc32_no_comp(0, (uchar *)ri, sizeof(*ri) - 8);
+	memcpy(ri + 1, data, len);
+
+	si->nodetype = ri->nodetype;
+	si->inode = ino;
+	si->version = ri->version;
+	si->offset = img->ofs - img->block;
+	si->totlen = ri->totlen;
+	img->sum_len += JFFS2_SUMMARY_INODE_SIZE;
+	img->sum_num++;
+
+	img->ofs += ALIGN(ri->totlen, 4);
+}
+
+static void jffs2_test_add_dirent(struct jffs2_test_img *img, u32 pino,
+				  u32 ino, u8 type, const char *name)
+{
+	struct jffs2_raw_dirent *rd = (void *)img->buf + img->ofs;
+	struct jffs2_sum_dirent_flash *sd = (void *)img->sum + img->sum_len;
+	u8 nsize = strlen(name);
+
+	memset(rd, '\0', sizeof(*rd));
+	rd->magic = JFFS2_MAGIC_BITMASK;
+	rd->nodetype = JFFS2_NODETYPE_DIRENT;
+	rd->totlen = sizeof(*rd) + nsize;
+	rd->hdr_crc = crc32_no_comp(0, (uchar *)rd,
+				    sizeof(struct jffs2_unknown_node) - 4);
+	rd->pino = pino;
+	rd->version = 1;
+	rd->ino = ino;
+	rd->mctime = JFFS2_TEST_TIME;
+	rd->nsize = nsize;
+	rd->type = type;
+	rd->node_crc = crc32_no_comp(0, (uchar *)rd, sizeof(*rd) - 8);
+	rd->name_crc = crc32_no_comp(0, (uchar *)name, nsize);
+	memcpy(rd->name, name, nsize);
+
+	sd->nodetype = rd->nodetype;
+	sd->totlen = rd->totlen;
+	sd->offset = img->ofs - img->block;
+	sd->pino = pino;
+	sd->version = rd->version;
+	sd->ino = ino;
+	sd->nsize = nsize;
+	sd->type = type;
+	memcpy(sd->name, name, nsize);
+	img->sum_len += JFFS2_SUMMARY_DIRENT_SIZE(nsize);
+	img->sum_num++;
+
+	img->ofs += ALIGN(rd->totlen, 4);
+}
+
+/* Write the summary, if any, at the end of the erase block and move on */
+static void jffs2_test_end_block(struct jffs2_test_img *img,
+				 enum jffs2_test_sum sum)
+{
+	struct jffs2_raw_summary *rs;
+	struct jffs2_sum_marker *sm;
+	u32 totlen, ofs;
+
+	if (sum != JFFS2_TEST_NO_SUM) {
+		totlen = ALIGN(sizeof(*rs) + img->sum_len + sizeof(*sm), 4);
+		ofs = JFFS2_TEST_SECTOR - totlen;
+		rs = (void *)img->buf + img->block + ofs;
+		sm = (void *)img->buf + img->block + JFFS2_TEST_SECTOR -
+			sizeof(*sm);
+
+		memset(rs, '\0', sizeof(*rs));
+		rs->magic = JFFS2_MAGIC_BITMASK;
+		rs->nodetype = JFFS2_NODETYPE_SUMMARY;
+		rs->totlen = totlen;
+		rs->hdr_crc = crc32_no_comp(0, (uchar *)rs,
+					sizeof(struct jffs2_unknown_node) - 4);
+		rs->sum_num = img->sum_num;
+		memcpy(rs->sum, img->sum, img->sum_len);
+		sm->offset = ofs;
+		sm->magic = JFFS2_SUM_MAGIC;
+		rs->sum_crc = crc32_no_comp(0, (uchar *)rs->sum,
+					    totlen - sizeof(*rs));
+		if (sum == JFFS2_TEST_BAD_SUM)
+			rs->sum_crc ^= 1;
+		rs->node_crc = crc32_no_comp(0, (uchar *)rs, sizeof(*rs) - 8);
+	}
+
+	img->block += JFFS2_TEST_SECTOR;
+	img->ofs = img->block;
+	img->sum_len = 0;
+	img->sum_num = 0;
+}
+
+/*
+ * Build an image with /a.txt, /dir and /dir/b.txt, the latter in the second
+ * erase block
+ */
+static void jffs2_test_build(u8 *buf, enum jffs2_test_sum sum)
+{
+	struct jffs2_test_img img = { .buf = buf };
+
+	memset(buf, 0xff, JFFS2_TEST_SIZE);
+	jffs2_test_add_dirent(&img, 1, 2, DT_REG, "a.txt");
+	jffs2_test_add_inode(&img, 2, S_IFREG | 0644, "first file\n");
+	jffs2_test_add_dirent(&img, 1, 3, DT_DIR, "dir");
+	jffs2_test_add_inode(&img, 3, S_IFDIR | 0755, "");
+	jffs2_test_end_block(&img, sum);
+
+	jffs2_test_add_dirent(&img, 3, 4, DT_REG, "b.txt");
+	jffs2_test_add_inode(&img, 4, S_IFREG | 0644, JFFS2_TEST_FILE);
+	jffs2_test_end_block(&img, sum);
+}
+
+/* Append all recorded console output to @out */
+static void jffs2_test_get_output(char *out, int size)
+{
+	char line[256];
+
+	while (console_record_avail()) {
+		console_record_readline(line, sizeof(line));
+		strlcat(out, line, size);
+		strlcat(out, "\n", size);
+	}
+}
+
+/**
+ * jffs2_test_scan() - Scan an image, list its files and read one back
+ *
+ * @uts: Test state
+ * @sum: Summary variant of the image to build
+ * @scan: Returns the output of the scan
+ * @list: Returns the listing of / and /dir
+ * @size: Size of @scan and @list
+ * Return: 0 if OK, -ve on error
+ */
+static int jffs2_test_scan(struct unit_test_state *uts,
+			   enum jffs2_test_sum sum, char *scan, char *list,
+			   int size)
+{
+	struct mtdids id = { .type = MTD_DEV_TYPE_NOR };
+	struct mtd_device mtd = { .id = &id };
+	struct part_info part = {
+		.name = "jffs2",
+		.size = JFFS2_TEST_SIZE,
+		.sector_size = JFFS2_TEST_SECTOR,
+		.dev = &mtd,
+	};
+	char data[sizeof(JFFS2_TEST_FILE)] = {};
+	u8 *buf;
+
+	buf = memalign(4, JFFS2_TEST_SIZE);
+	ut_assertnonnull(buf);
+	jffs2_test_build(buf, sum);
+	part.offset = map_to_sysmem(buf);
+
+	*scan = '\0';
+	*list = '\0';
+	console_record_reset_enable();
+	ut_asserteq(1, jffs2_1pass_info(&part));
+	jffs2_test_get_output(scan, size);
+
+	/* The lists are kept, so this does not scan again */
+	ut_asserteq(1, jffs2_1pass_ls(&part, "/"));
+	ut_asserteq(1, jffs2_1pass_ls(&part, "/dir"));
+	jffs2_test_get_output(list, size);
+
+	ut_asserteq(strlen(JFFS2_TEST_FILE),
+		    jffs2_1pass_load(data, &part, "/dir/b.txt"));
+	ut_asserteq_str(JFFS2_TEST_FILE, data);
+	ut_assert_console_end();
+
+	jffs2_free_cache(&part);
+	free(buf);
+
+	return 0;
+}
+
+/* Scanning through the summary must find the same files as a full scan */
+static int dm_test_jffs2_summary(struct unit_test_state *uts)
+{
+	char scan[512], list[512], sum_scan[512], sum_list[512];
+
+	ut_assertok(jffs2_test_scan(uts, JFFS2_TEST_NO_SUM, scan, list,
+				    sizeof(scan)));
+	ut_assertnonnull(strstr(list, " a.txt"));
+	ut_assertnonnull(strstr(list, " dir"));
+	ut_assertnonnull(strstr(list, " b.txt"));
+
+	/* The full scan shows progress for each dirent, the summary does not */
+	ut_assertok(jffs2_test_scan(uts, JFFS2_TEST_SUM, sum_scan, sum_list,
+				    sizeof(sum_scan)));
+	ut_assertnonnull(strstr(scan, ".  "));
+	ut_assertnull(strstr(sum_scan, ".  "));
+	ut_assertnull(strstr(sum_scan, "Summary node crc error"));
+	ut_asserteq_str(list, sum_list);
+
+	/* A bad summary falls back to the full scan */
+	ut_assertok(jffs2_test_scan(uts, JFFS2_TEST_BAD_SUM, sum_scan,
+				    sum_list, sizeof(sum_scan)));
+	ut_assertnonnull(strstr(sum_scan, "Summary node crc error"));
+	ut_assertnonnull(strstr(sum_scan, ".  "));
+	ut_asserteq_str(list, sum_list);
+
+	return 0;
+}
+DM_TEST(dm_test_jffs2_summary, UT_TESTF_CONSOLE_REC);
@@ -106,3 +106,57 @@ static int dm_test_part_bootable(struct unit_test_state *uts)
 	return 0;
 }
 DM_TEST(dm_test_part_bootable, UT_TESTF_SCAN_FDT);
+
+static int dm_test_part_gpt_cache(struct unit_test_state *uts)
+{
+	struct disk_partition parts[2] = {
+		{
+			.start = 48,
+			.size = 1,
+			.name = "test1",
+		},
+		{
+			.start = 49,
+			.size = 1,
+			.name = "test2",
+		},
+	};
+	char str_disk_guid[UUID_STR_LEN + 1];
+	struct blk_desc *mmc_dev_desc;
+	struct disk_partition info;
+	char data[512];
+
+	ut_asserteq(2, blk_get_device_by_str("mmc", "2", &mmc_dev_desc));
+	if (CONFIG_IS_ENABLED(RANDOM_UUID)) {
+		gen_rand_uuid_str(parts[0].uuid, UUID_STR_FORMAT_STD);
+		gen_rand_uuid_str(parts[1].uuid, UUID_STR_FORMAT_STD);
+		gen_rand_uuid_str(str_disk_guid, UUID_STR_FORMAT_STD);
+	}
+	ut_assertok(gpt_restore(mmc_dev_desc, str_disk_guid, parts,
+				ARRAY_SIZE(parts)));
+	ut_assertok(part_get_info(mmc_dev_desc, 1, &info));
+	ut_asserteq_str("test1", (char *)info.name);
+
+	/* Writing inside a partition keeps the cached table valid */
+	memset(data, '\0', sizeof(data));
+	ut_asserteq(1, blk_dwrite(mmc_dev_desc, parts[1].start, 1, data));
+	ut_asserteq(2, part_get_info_by_name(mmc_dev_desc, "test2", &info));
+
+	/* Rewriting the GPT must drop the cached copy */
+	strcpy((char *)parts[0].name, "new1");
+	strcpy((char *)parts[1].name, "new2");
+	ut_assertok(gpt_restore(mmc_dev_desc, str_disk_guid, parts,
+				ARRAY_SIZE(parts)));
+	ut_assertok(part_get_info(mmc_dev_desc, 1, &info));
+	ut_asserteq_str("new1", (char *)info.name);
+	ut_asserteq(2, part_get_info_by_name(mmc_dev_desc, "new2", &info));
+	ut_asserteq(-ENOENT, part_get_info_by_name(mmc_dev_desc, "test2",
+						   &info));
+
+	/* Re-initialising the device drops it too */
+	part_init(mmc_dev_desc);
+	ut_asserteq(2, part_get_info_by_name(mmc_dev_desc, "new2", &info));
+
+	return 0;
+}
+DM_TEST(dm_test_part_gpt_cache, UT_TESTF_SCAN_PDATA | UT_TESTF_SCAN_FDT);
@@ -0,0 +1,140 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for the environment journal
+ *
+ * The journal area is kept in memory here, standing in for the flash or
+ * eMMC the drivers write it to.
+ */
+
+#include <common.h>
+#include <env.h>
+#include <env_internal.h>
+#include <malloc.h>
+#include <search.h>
+#include <test/env.h>
+#include <test/ut.h>
+
+static u8 journal_medium[CONFIG_ENV_JOURNAL_SIZE];
+
+/* Append the changed variables and "write" them to the medium */
+static int journal_save(struct unit_test_state *uts, size_t *offp,
+			size_t *lenp)
+{
+	u8 *log;
+
+	ut_assertok(env_journal_append(&log, offp, lenp));
+	memcpy(journal_medium + *offp, log + *offp, *lenp);
+	env_journal_written(0);
+
+	return 0;
+}
+
+static int env_test_journal(struct unit_test_state *uts)
+{
+	size_t off, len, used;
+	env_t *base;
+	u8 *log;
+
+	base = malloc(sizeof(*base));
+	ut_assertnonnull(base);
+
+	ut_assertok(env_set("jnl_keep", "1"));
+	ut_assertok(env_set("jnl_gone", "2"));
+	ut_assertok(env_set("jnl_change", "3"));
+
+	/* What a full save leaves behind: the environment, empty journal */
+	ut_assertok(env_export(base));
+	ut_assertok(env_journal_reset(&log));
+	memcpy(journal_medium, log, CONFIG_ENV_JOURNAL_SIZE);
+
+	/* Nothing changed, nothing to write */
+	ut_assertok(journal_save(uts, &off, &len));
+	ut_asserteq(0, off);
+	ut_asserteq(0, len);
+
+	ut_assertok(env_set("jnl_gone", NULL));
+	ut_assertok(env_set("jnl_change", "4"));
+	ut_assertok(env_set("jnl_new", "5"));
+	ut_assertok(journal_save(uts, &off, &len));
+	ut_asserteq(0, off);
+	ut_assert(len > 0 && len <= 3 * 32);
+	used = len;
+
+	/* Later saves append after the earlier records */
+	ut_assertok(env_set("jnl_new", "6"));
+	ut_assertok(journal_save(uts, &off, &len));
+	ut_asserteq(used, off);
+	ut_assert(len > 0 && len <= 32);
+	used += len;
+
+	/* Loading replays the journal on top of the stored environment */
+	ut_assertok(env_import((char *)base, 1, H_EXTERNAL));
+	ut_asserteq_str("2", env_get("jnl_gone"));
+	ut_assertnull(env_get("jnl_new"));
+	ut_assertok(env_journal_load(base->crc, journal_medium, H_EXTERNAL));
+	ut_asserteq_str("1", env_get("jnl_keep"));
+	ut_assertnull(env_get("jnl_gone"));
+	ut_asserteq_str("4", env_get("jnl_change"));
+	ut_asserteq_str("6", env_get("jnl_new"));
+
+	ut_assertok(journal_save(uts, &off, &len));
+	ut_asserteq(used, off);
+	ut_asserteq(0, len);
+
+	/* Records for another copy of the environment are ignored */
+	ut_assertok(env_import((char *)base, 1, H_EXTERNAL));
+	ut_assertok(env_journal_load(base->crc + 1, journal_medium,
+				     H_EXTERNAL));
+	ut_asserteq_str("2", env_get("jnl_gone"));
+	ut_asserteq_str("3", env_get("jnl_change"));
+	ut_assertnull(env_get("jnl_new"));
+
+	/* and cannot be appended to, so the next save rewrites everything */
+	ut_asserteq(-ENOENT, env_journal_append(&log, &off, &len));
+
+	env_journal_forget();
+	ut_assertok(env_set("jnl_keep", NULL));
+	ut_assertok(env_set("jnl_gone", NULL));
+	ut_assertok(env_set("jnl_change", NULL));
+	free(base);
+
+	return 0;
+}
+ENV_TEST(env_test_journal, 0);
+
+static int env_test_journal_full(struct unit_test_state *uts)
+{
+	size_t off, len;
+	char val[100];
+	u8 *log;
+	int i, ret;
+
+	ut_assertok(env_journal_reset(NULL));
+
+	memset(val, 'x', sizeof(val) - 1);
+	val[sizeof(val) - 1] = '\0';
+	for (i = 0; ; i++) {
+		ut_assert(i < CONFIG_ENV_JOURNAL_SIZE / 100);
+		sprintf(val, "%d", i);
+		val[strlen(val)] = 'x';
+		ut_assertok(env_set("jnl_full", val));
+		ret = env_journal_append(&log, &off, &len);
+		if (ret)
+			break;
+		ut_asserteq(1, !!len);
+		env_journal_written(0);
+	}
+	ut_asserteq(-ENOSPC, ret);
+
+	/* Once the environment is rewritten the journal starts over */
+	ut_assertok(env_journal_reset(NULL));
+	ut_assertok(env_journal_append(&log, &off, &len));
+	ut_asserteq(0, off);
+	ut_asserteq(0, len);
+
+	env_journal_forget();
+	ut_assertok(env_set("jnl_full", NULL));
+
+	return 0;
+}
+ENV_TEST(env_test_journal_full, 0);
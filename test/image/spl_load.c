@@ -5,10 +5,12 @@
  */
 
 #include <common.h>
+#include <bootstage.h>
 #include <image.h>
 #include <mapmem.h>
 #include <os.h>
 #include <spl.h>
+#include <asm/cache.h>
 #include <test/ut.h>
 
 /* Declare a new SPL test */
@@ -89,3 +91,255 @@ static int spl_test_load(struct unit_test_state *uts)
 	return 0;
 }
 SPL_TEST(spl_test_load, 0);
+
+/* Where the test FIT is stored and where its image is loaded */
+#define TEST_DISK_ADDR		0x400000
+#define TEST_LOAD_ADDR		0x200000
+
+/* Checks on board_fit_image_load_progress() calls for the loading image */
+static struct {
+	const u8 *expect;	/* expected image data, NULL to ignore calls */
+	size_t loaded;		/* bytes loaded according to the last call */
+	bool started;		/* seen the call with loaded == 0 */
+	bool ok;		/* all calls so far were as expected */
+} progress;
+
+void board_fit_image_load_progress(const void *fit, int node,
+				   const void *image, size_t loaded,
+				   size_t size)
+{
+	if (!progress.expect)
+		return;
+
+	if (!loaded) {
+		progress.started = true;
+		progress.loaded = 0;
+		return;
+	}
+
+	if (!progress.started || loaded < progress.loaded || loaded > size ||
+	    memcmp(image, progress.expect, loaded))
+		progress.ok = false;
+	progress.loaded = loaded;
+}
+
+/* Where read_mem_image() put data, relative to the image destination */
+static struct {
+	u8 *dst;		/* destination of the image, NULL to ignore */
+	size_t len;		/* size of the image */
+	uint in_place;		/* reads straight into the destination */
+	uint staged;		/* reads around the destination, not into it */
+} reads;
+
+static ulong read_mem_image(struct spl_load_info *load, ulong sector,
+			    ulong count, void *buf)
+{
+	u8 *start = buf, *end = start + count * load->bl_len;
+
+	memcpy(buf, load->priv + sector * load->bl_len, count * load->bl_len);
+	if (reads.dst) {
+		if (start >= reads.dst && end <= reads.dst + reads.len)
+			reads.in_place++;
+		else if (end > reads.dst - 64 &&
+			 start < reads.dst + reads.len + 64)
+			reads.staged++;
+	}
+
+	return count;
+}
+
+/**
+ * spl_test_fit_create() - create a FIT with one external 'firmware' image
+ *
+ * @fit: Buffer to create the FIT in
+ * @size: Size of @fit
+ * @offset: Offset of the image data from the end of the FIT
+ * @len: Size of the image data in bytes
+ * @load_addr: Load address of the image
+ * Return: 0 if OK, -ve on error
+ */
+static int spl_test_fit_create(void *fit, int size, uint offset, uint len,
+			       ulong load_addr)
+{
+	int ret;
+
+	ret = fdt_create(fit, size);
+	ret |= fdt_finish_reservemap(fit);
+	ret |= fdt_begin_node(fit, "");
+	ret |= fdt_begin_node(fit, "images");
+	ret |= fdt_begin_node(fit, "firmware-1");
+	ret |= fdt_property_string(fit, FIT_TYPE_PROP, "firmware");
+	ret |= fdt_property_string(fit, FIT_OS_PROP, "arm-trusted-firmware");
+	ret |= fdt_property_u32(fit, FIT_DATA_OFFSET_PROP, offset);
+	ret |= fdt_property_u32(fit, FIT_DATA_SIZE_PROP, len);
+	ret |= fdt_property_u32(fit, FIT_LOAD_PROP, load_addr);
+	ret |= fdt_end_node(fit);
+	ret |= fdt_end_node(fit);
+	ret |= fdt_begin_node(fit, "configurations");
+	ret |= fdt_property_string(fit, FIT_DEFAULT_PROP, "conf-1");
+	ret |= fdt_begin_node(fit, "conf-1");
+	ret |= fdt_property_string(fit, FIT_FIRMWARE_PROP, "firmware-1");
+	ret |= fdt_end_node(fit);
+	ret |= fdt_end_node(fit);
+	ret |= fdt_end_node(fit);
+	ret |= fdt_finish(fit);
+
+	return ret ? -EINVAL : 0;
+}
+
+/* Load one external image and check that exactly its bytes were written */
+static int spl_test_fit_align_one(struct unit_test_state *uts, int bl_len,
+				  uint offset, uint len, ulong load_addr)
+{
+	struct spl_image_info image;
+	struct spl_load_info load;
+	const int fit_size = 1024;
+	uint ext_offset, disk_size, blksz, head, nr_blocks;
+	u8 *disk, *data, *dst;
+	bool direct;
+	uint i;
+
+	disk_size = ALIGN(fit_size + offset + len + bl_len, bl_len);
+	disk = map_sysmem(TEST_DISK_ADDR, disk_size);
+	memset(disk, '\0', disk_size);
+	ut_assertok(spl_test_fit_create(disk, fit_size, offset, len,
+					load_addr));
+	ext_offset = ALIGN(fdt_totalsize(disk), 4);
+	data = disk + ext_offset + offset;
+	for (i = 0; i < len; i++)
+		data[i] = i * 7 + offset;
+
+	/* Guard bytes around the destination */
+	dst = map_sysmem(load_addr, len);
+	memset(dst - 64, 0xa5, len + 128);
+
+	memset(&load, '\0', sizeof(load));
+	memset(&image, '\0', sizeof(image));
+	load.bl_len = bl_len;
+	load.read = read_mem_image;
+	load.priv = disk;
+	if (bl_len == 1)
+		load.filename = "test.fit";
+
+	/*
+	 * The whole blocks are read in place unless they would land on an
+	 * address unsuitable for DMA
+	 */
+	blksz = bl_len;
+	head = (ext_offset + offset) % blksz;
+	head = head ? min(len, blksz - head) : 0;
+	nr_blocks = (len - head) / blksz;
+	direct = !nr_blocks ||
+		IS_ALIGNED(load_addr + head, ARCH_DMA_MINALIGN);
+
+	progress.expect = data;
+	progress.started = false;
+	progress.ok = true;
+	memset(&reads, '\0', sizeof(reads));
+	reads.dst = dst;
+	reads.len = len;
+	ut_assertok(spl_load_simple_fit(&image, &load, 0, disk));
+	reads.dst = NULL;
+	progress.expect = NULL;
+	ut_assert(progress.ok);
+	ut_asserteq(len, progress.loaded);
+	ut_asserteq(load_addr, image.load_addr);
+	ut_asserteq(len, image.size);
+	ut_asserteq_mem(data, dst, len);
+	for (i = 1; i <= 64; i++)
+		ut_asserteq(0xa5, dst[-i]);
+
+	if (direct) {
+		/* Nothing is staged and nothing past the image is written */
+		ut_asserteq(0, reads.staged);
+		ut_asserteq(!!nr_blocks, !!reads.in_place);
+		for (i = 0; i < 64; i++)
+			ut_asserteq(0xa5, dst[len + i]);
+	} else {
+		ut_assert(reads.staged);
+	}
+
+	unmap_sysmem(dst);
+	unmap_sysmem(disk);
+
+	return 0;
+}
+
+/* Test loading external FIT data for each alignment of source and target */
+static int spl_test_fit_align(struct unit_test_state *uts)
+{
+	static const uint offsets[] = { 0, 1, 4, 15, 508, 511, 512, 513 };
+	static const uint lens[] = { 1, 3, 100, 511, 512, 1000, 4096, 5000 };
+	static const uint misalign[] = { 0, 1, 4, 15, 16, 100 };
+	static const int bl_lens[] = { 512, 1 };
+	int b, o, l, m;
+
+	for (b = 0; b < ARRAY_SIZE(bl_lens); b++) {
+		for (o = 0; o < ARRAY_SIZE(offsets); o++) {
+			for (l = 0; l < ARRAY_SIZE(lens); l++) {
+				for (m = 0; m < ARRAY_SIZE(misalign); m++) {
+					ut_assertok(spl_test_fit_align_one(uts,
+						bl_lens[b], offsets[o], lens[l],
+						TEST_LOAD_ADDR + misalign[m]));
+				}
+			}
+		}
+	}
+
+	return 0;
+}
+SPL_TEST(spl_test_fit_align, 0);
+
+/* Like read_mem_image() but always taking some time */
+static ulong read_slow_image(struct spl_load_info *load, ulong sector,
+			     ulong count, void *buf)
+{
+	ulong start = timer_get_boot_us();
+
+	while (timer_get_boot_us() == start)
+		;
+
+	return read_mem_image(load, sector, count, buf);
+}
+
+/* Check that the time spent reading external FIT data is recorded */
+static int spl_test_fit_bootstage(struct unit_test_state *uts)
+{
+	struct spl_image_info image;
+	struct spl_load_info load;
+	const int fit_size = 1024;
+	const uint len = 0x1000;
+	ulong read_us, verify_us;
+	u8 *disk;
+
+	if (!CONFIG_IS_ENABLED(BOOTSTAGE))
+		return -EAGAIN;
+
+	disk = map_sysmem(TEST_DISK_ADDR, fit_size + len);
+	memset(disk, '\0', fit_size + len);
+	ut_assertok(spl_test_fit_create(disk, fit_size, 0, len,
+					TEST_LOAD_ADDR));
+
+	memset(&load, '\0', sizeof(load));
+	memset(&image, '\0', sizeof(image));
+	load.bl_len = 1;
+	load.read = read_slow_image;
+	load.priv = disk;
+	load.filename = "test.fit";
+
+	read_us = bootstage_get_time(BOOTSTAGE_ID_ACCUM_SPL_FIT_READ);
+	verify_us = bootstage_get_time(BOOTSTAGE_ID_ACCUM_SPL_FIT_VERIFY);
+	ut_assertok(spl_load_simple_fit(&image, &load, 0, disk));
+	ut_assert(bootstage_get_time(BOOTSTAGE_ID_ACCUM_SPL_FIT_READ) >
+		  read_us);
+
+	/* Hashes are only checked, and so timed, with FIT_SIGNATURE */
+	if (!CONFIG_IS_ENABLED(FIT_SIGNATURE))
+		ut_asserteq(verify_us,
+			    bootstage_get_time(BOOTSTAGE_ID_ACCUM_SPL_FIT_VERIFY));
+
+	unmap_sysmem(disk);
+
+	return 0;
+}
+SPL_TEST(spl_test_fit_bootstage, 0);
@@ -5,6 +5,7 @@
 
 #include <common.h>
 #include <efi_loader.h>
+#include <hash.h>
 #include <test/lib.h>
 #include <test/test.h>
 #include <test/ut.h>
@@ -161,3 +162,66 @@ static int lib_test_efi_image_region_sort(struct unit_test_state *uts)
 }
 
 LIB_TEST(lib_test_efi_image_region_sort, 0);
+
+static int lib_test_efi_image_hash(struct unit_test_state *uts)
+{
+	static const char *const algos[] = { "sha256", "sha384", "sha256" };
+	const size_t size = 200 * 1024;
+	struct efi_image_regions *regs;
+	u8 expect[HASH_MAX_DIGEST_SIZE];
+	const u8 *digest, *digest2;
+	int i, len;
+	u8 *buf;
+
+	buf = malloc(size);
+	ut_assertnonnull(buf);
+	for (i = 0; i < size; i++)
+		buf[i] = i * 7 + (i >> 9);
+
+	regs = calloc(sizeof(*regs) +
+		      sizeof(struct image_region) * UT_REG_CAPACITY, 1);
+	ut_assertnonnull(regs);
+	regs->max = UT_REG_CAPACITY;
+
+	/* Regions larger than the chunks each algorithm is passed */
+	ut_asserteq_64(EFI_SUCCESS,
+		       efi_image_region_add(regs, buf, buf + 0x58, 0));
+	ut_asserteq_64(EFI_SUCCESS,
+		       efi_image_region_add(regs, buf + 0x5c, buf + 0x400, 0));
+	ut_asserteq_64(EFI_SUCCESS,
+		       efi_image_region_add(regs, buf + 0x400,
+					    buf + size - 0x1234, 0));
+
+	/* All digests are computed in one pass, duplicates only once */
+	ut_assertok(efi_image_hash(regs, algos, ARRAY_SIZE(algos)));
+	ut_asserteq(2, regs->num_digests);
+
+	ut_assertok(hash_calculate("sha256", regs->reg, regs->num, expect));
+	digest = efi_image_digest(regs, "sha256", &len);
+	ut_assertnonnull(digest);
+	ut_asserteq(32, len);
+	ut_asserteq_mem(expect, digest, len);
+
+	ut_assertok(hash_calculate("sha384", regs->reg, regs->num, expect));
+	digest = efi_image_digest(regs, "sha384", &len);
+	ut_assertnonnull(digest);
+	ut_asserteq(48, len);
+	ut_asserteq_mem(expect, digest, len);
+
+	/* Digests are kept, even if the image changes afterwards */
+	buf[0x100] ^= 0xff;
+	digest2 = efi_image_digest(regs, "sha384", &len);
+	ut_asserteq_ptr(digest, digest2);
+	ut_asserteq_mem(expect, digest2, len);
+	ut_asserteq(2, regs->num_digests);
+
+	ut_assertnull(efi_image_digest(regs, "nosuchhash", &len));
+	ut_asserteq(2, regs->num_digests);
+
+	free(regs);
+	free(buf);
+
+	return 0;
+}
+
+LIB_TEST(lib_test_efi_image_hash, 0);
@@ -9,7 +9,9 @@
 #include <command.h>
 #include <hexdump.h>
 #include <rand.h>
+#include <time.h>
 #include <uboot_aes.h>
+#include <linux/sizes.h>
 #include <test/lib.h>
 #include <test/test.h>
 #include <test/ut.h>
@@ -166,3 +168,79 @@ static int lib_test_aes(struct unit_test_state *uts)
 }
 
 LIB_TEST(lib_test_aes, 0);
+
+/* Known-answer tests from FIPS-197 appendix C */
+static const u8 fips197_plain[AES_BLOCK_LENGTH] = {
+	0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+	0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff,
+};
+
+static const struct {
+	int key_len;
+	u8 cipher[AES_BLOCK_LENGTH];
+} fips197_vectors[] = {
+	{ AES128_KEY_LENGTH, {
+		0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30,
+		0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a } },
+	{ AES192_KEY_LENGTH, {
+		0xdd, 0xa9, 0x7c, 0xa4, 0x86, 0x4c, 0xdf, 0xe0,
+		0x6e, 0xaf, 0x70, 0xa0, 0xec, 0x0d, 0x71, 0x91 } },
+	{ AES256_KEY_LENGTH, {
+		0x8e, 0xa2, 0xb7, 0xca, 0x51, 0x67, 0x45, 0xbf,
+		0xea, 0xfc, 0x49, 0x90, 0x4b, 0x49, 0x60, 0x89 } },
+};
+
+static int lib_test_aes_fips197(struct unit_test_state *uts)
+{
+	u8 key_exp[AES256_EXPAND_KEY_LENGTH];
+	u8 key[AES256_KEY_LENGTH];
+	u8 out[AES_BLOCK_LENGTH];
+	int i;
+
+	/* The key is 00 01 02 ... for all key sizes */
+	for (i = 0; i < sizeof(key); i++)
+		key[i] = i;
+
+	for (i = 0; i < ARRAY_SIZE(fips197_vectors); i++) {
+		int key_len = fips197_vectors[i].key_len;
+
+		aes_expand_key(key, key_len, key_exp);
+		aes_encrypt(key_len, (u8 *)fips197_plain, key_exp, out);
+		ut_asserteq_mem(fips197_vectors[i].cipher, out,
+				AES_BLOCK_LENGTH);
+		aes_decrypt(key_len, (u8 *)fips197_vectors[i].cipher, key_exp,
+			    out);
+		ut_asserteq_mem(fips197_plain, out, AES_BLOCK_LENGTH);
+	}
+
+	return 0;
+}
+LIB_TEST(lib_test_aes_fips197, 0);
+
+/* Report CBC decryption speed, as used for encrypted FIT images */
+static int lib_test_aes_speed(struct unit_test_state *uts)
+{
+	u8 key_exp[AES256_EXPAND_KEY_LENGTH];
+	u8 key[AES256_KEY_LENGTH];
+	u8 iv[AES_BLOCK_LENGTH];
+	u32 num_block = SZ_1M / AES_BLOCK_LENGTH;
+	ulong start, delta;
+	u8 *buf;
+
+	buf = malloc(SZ_1M);
+	ut_assertnonnull(buf);
+	rand_buf(key, sizeof(key));
+	rand_buf(iv, sizeof(iv));
+	rand_buf(buf, SZ_1M);
+	aes_expand_key(key, AES256_KEY_LENGTH, key_exp);
+
+	start = timer_get_us();
+	aes_cbc_decrypt_blocks(AES256_KEY_LENGTH, key_exp, iv, buf, buf,
+			       num_block);
+	delta = timer_get_us() - start;
+	printf("aes256-cbc: decrypted 1 MiB in %lu us\n", delta);
+	free(buf);
+
+	return 0;
+}
+LIB_TEST(lib_test_aes_speed, 0);
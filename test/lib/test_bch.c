@@ -0,0 +1,132 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Unit tests for the software BCH encoder/decoder
+ */
+
+#include <common.h>
+#include <rand.h>
+#include <time.h>
+#include <linux/bch.h>
+#include <test/lib.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+#define TEST_BCH_LEN		512
+#define TEST_BCH_ROUNDS		100
+#define TEST_BCH_SPEED_STEPS	2000
+
+/**
+ * lib_test_bch_one() - Check error correction for one BCH configuration
+ *
+ * Each round encodes random data, flips between 0 and @t distinct data bits
+ * and checks that decode_bch() reports exactly those bits.
+ *
+ * @uts: Test state
+ * @m: Galois field order
+ * @t: Number of correctable errors
+ * Return: 0 if OK, -ve on error
+ */
+static int lib_test_bch_one(struct unit_test_state *uts, int m, int t)
+{
+	u8 data[TEST_BCH_LEN], orig[TEST_BCH_LEN], ecc[64];
+	unsigned int errloc[64];
+	struct bch_control *bch;
+	int round, i, nerr;
+	uint bit;
+
+	bch = init_bch(m, t, 0);
+	ut_assertnonnull(bch);
+	ut_assert(bch->ecc_bytes <= sizeof(ecc));
+
+	srand(m * 100 + t);
+	for (round = 0; round < TEST_BCH_ROUNDS; round++) {
+		for (i = 0; i < TEST_BCH_LEN; i++)
+			orig[i] = rand();
+		memset(ecc, '\0', sizeof(ecc));
+		encode_bch(bch, orig, TEST_BCH_LEN, ecc);
+
+		memcpy(data, orig, TEST_BCH_LEN);
+		nerr = round % (t + 1);
+		for (i = 0; i < nerr; i++) {
+			do {
+				bit = rand() % (TEST_BCH_LEN * 8);
+			} while ((data[bit / 8] ^ orig[bit / 8]) &
+				 (1 << (bit % 8)));
+			data[bit / 8] ^= 1 << (bit % 8);
+		}
+
+		ut_asserteq(nerr, decode_bch(bch, data, TEST_BCH_LEN, ecc,
+					     NULL, NULL, errloc));
+		for (i = 0; i < nerr; i++) {
+			ut_assert(errloc[i] < TEST_BCH_LEN * 8);
+			data[errloc[i] / 8] ^= 1 << (errloc[i] % 8);
+		}
+		ut_asserteq_mem(orig, data, TEST_BCH_LEN);
+	}
+	free_bch(bch);
+
+	return 0;
+}
+
+/* Test BCH4, BCH8 and BCH16 as used for 512-byte NAND ECC steps */
+static int lib_test_bch(struct unit_test_state *uts)
+{
+	ut_assertok(lib_test_bch_one(uts, 13, 4));
+	ut_assertok(lib_test_bch_one(uts, 13, 8));
+	ut_assertok(lib_test_bch_one(uts, 13, 16));
+
+	return 0;
+}
+LIB_TEST(lib_test_bch, 0);
+
+/* Time decoding of clean steps and of steps with @t errors */
+static int lib_test_bch_speed_one(struct unit_test_state *uts, int m, int t)
+{
+	u8 data[TEST_BCH_LEN], ecc[64];
+	unsigned int errloc[64];
+	struct bch_control *bch;
+	ulong clean, dirty;
+	int i, errs;
+
+	bch = init_bch(m, t, 0);
+	ut_assertnonnull(bch);
+
+	for (i = 0; i < TEST_BCH_LEN; i++)
+		data[i] = rand();
+	memset(ecc, '\0', sizeof(ecc));
+	encode_bch(bch, data, TEST_BCH_LEN, ecc);
+
+	clean = timer_get_us();
+	for (i = 0; i < TEST_BCH_SPEED_STEPS; i++)
+		ut_asserteq(0, decode_bch(bch, data, TEST_BCH_LEN, ecc, NULL,
+					  NULL, errloc));
+	clean = timer_get_us() - clean;
+
+	/* The data stays corrupted, so each round finds the same errors */
+	for (i = 0; i < t; i++)
+		data[i * 13] ^= 1 << (i % 8);
+	dirty = timer_get_us();
+	for (i = 0; i < TEST_BCH_SPEED_STEPS; i++) {
+		errs = decode_bch(bch, data, TEST_BCH_LEN, ecc, NULL, NULL,
+				  errloc);
+		ut_asserteq(t, errs);
+	}
+	dirty = timer_get_us() - dirty;
+	free_bch(bch);
+
+	printf("BCH%d: %d steps: %lu us clean, %lu us with %d errors\n", t,
+	       TEST_BCH_SPEED_STEPS, clean, dirty, t);
+
+	return 0;
+}
+
+/* Report the decoding speed for the configurations tested above */
+static int lib_test_bch_speed(struct unit_test_state *uts)
+{
+	ut_assertok(lib_test_bch_speed_one(uts, 13, 4));
+	ut_assertok(lib_test_bch_speed_one(uts, 13, 8));
+	ut_assertok(lib_test_bch_speed_one(uts, 13, 16));
+
+	return 0;
+}
+LIB_TEST(lib_test_bch_speed, 0);
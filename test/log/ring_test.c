@@ -0,0 +1,133 @@
+// SPDX-License-Identifier: GPL-2.0+
+/*
+ * Tests for the ring buffer log driver
+ */
+
+#include <common.h>
+#include <console.h>
+#include <log.h>
+#include <asm/global_data.h>
+#include <linux/sizes.h>
+#include <test/log.h>
+#include <test/test.h>
+#include <test/ut.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+static u64 ring_buf[SZ_1K / sizeof(u64)];
+
+/* Check the next line of the dump, ignoring its timestamp */
+static int ring_check_line(struct unit_test_state *uts, const char *expect)
+{
+	const char *msg;
+
+	ut_assert(console_record_readline(uts->actual_str,
+					  sizeof(uts->actual_str)) >= 0);
+	msg = strstr(uts->actual_str, "] ");
+	ut_assertnonnull(msg);
+	ut_asserteq_str(expect, msg + 2);
+
+	return 0;
+}
+
+static int ring_check_dropped(struct unit_test_state *uts)
+{
+	ut_assert(console_record_readline(uts->actual_str,
+					  sizeof(uts->actual_str)) >= 0);
+	ut_assertnonnull(strstr(uts->actual_str, "older records dropped"));
+
+	return 0;
+}
+
+/* Check the "record <n>" lines up to n = 99, returning the first n */
+static int ring_check_records(struct unit_test_state *uts, int *firstp)
+{
+	char expect[20];
+	int i;
+
+	ut_assert(console_record_readline(uts->actual_str,
+					  sizeof(uts->actual_str)) >= 0);
+	ut_assertnonnull(strstr(uts->actual_str, "] record "));
+	*firstp = dectoul(strstr(uts->actual_str, "] record ") + 9, NULL);
+	for (i = *firstp + 1; i < 100; i++) {
+		snprintf(expect, sizeof(expect), "record %d", i);
+		ut_assertok(ring_check_line(uts, expect));
+	}
+
+	return 0;
+}
+
+static int ring_dump_start(struct unit_test_state *uts)
+{
+	console_record_reset_enable();
+	log_ring_dump();
+	ut_unsilence_console(uts);
+
+	return 0;
+}
+
+static int log_test_ring(struct unit_test_state *uts)
+{
+	int log_fmt = gd->log_fmt;
+	int log_level = gd->default_log_level;
+	char expect[64], str[16];
+	ulong addr = 0x1234;
+	int i, first;
+
+	memset(ring_buf, '\0', sizeof(ring_buf));
+	ut_assertok(log_ring_setup(ring_buf, sizeof(ring_buf)));
+	gd->log_fmt = BIT(LOGF_MSG);
+	gd->default_log_level = LOGL_INFO;
+
+	/* Arguments are stored and only formatted by the dump */
+	ut_silence_console(uts);
+	strcpy(str, "before");
+	log(LOGC_NONE, LOGL_INFO, "%d %5lu %llx %zd %c %% %*d %.*s %s|%-3s|\n",
+	    -12, 34UL, 0x1234567890ULL, (ssize_t)-5, 'x', 3, 7, 2, "abc",
+	    str, "ab");
+	strcpy(str, "after");
+	/* %p extensions are formatted straight away */
+	log(LOGC_NONE, LOGL_INFO, "addr %pa\n", &addr);
+	log(LOGC_NONE, LOGL_INFO, "no ");
+	log(LOGC_CONT, LOGL_CONT, "newline\n");
+	ut_assertok(ring_dump_start(uts));
+	ut_assertok(ring_check_line(uts,
+				    "-12    34 1234567890 -5 x %   7 ab before|"
+				    "ab |"));
+	snprintf(expect, sizeof(expect), "addr %pa", &addr);
+	ut_assertok(ring_check_line(uts, expect));
+	ut_assertok(ring_check_line(uts, "no newline"));
+	ut_assertok(ut_check_console_end(uts));
+
+	/* Once the ring is full the oldest records are dropped */
+	ut_silence_console(uts);
+	for (i = 0; i < 100; i++)
+		log(LOGC_NONE, LOGL_INFO, "record %d\n", i);
+	ut_assertok(ring_dump_start(uts));
+	ut_assertok(ring_check_dropped(uts));
+	ut_assertok(ring_check_records(uts, &first));
+	ut_assert(first > 0);
+	ut_assertok(ut_check_console_end(uts));
+
+	/* The records survive setting up the same buffer again */
+	ut_assertok(log_ring_setup(ring_buf, sizeof(ring_buf)));
+	ut_assertok(ring_dump_start(uts));
+	ut_assertok(ring_check_dropped(uts));
+	ut_assertok(ring_check_records(uts, &i));
+	ut_assert(i >= first);
+	ut_assertok(ring_check_line(uts, "--- boot 2 ---"));
+	ut_assertok(ut_check_console_end(uts));
+
+	/* but not a corrupted header */
+	ring_buf[0] = 0;
+	ut_assertok(log_ring_setup(ring_buf, sizeof(ring_buf)));
+	ut_assertok(ring_dump_start(uts));
+	ut_assertok(ut_check_console_end(uts));
+
+	gd->default_log_level = log_level;
+	gd->log_fmt = log_fmt;
+	ut_assertok(log_ring_setup(NULL, 0));
+
+	return 0;
+}
+LOG_TEST_FLAGS(log_test_ring, UT_TESTF_CONSOLE_REC);